@@ -0,0 +1,177 @@
+/*!@file Envision/env_alloc.c Recycling memory allocator for envision images and pyramids */
+
+// //////////////////////////////////////////////////////////////////// //
+// The iLab Neuromorphic Vision C++ Toolkit - Copyright (C) 2001 by the //
+// University of Southern California (USC) and the iLab at USC.         //
+// See http://iLab.usc.edu for information about this project.          //
+// //////////////////////////////////////////////////////////////////// //
+// Major portions of the iLab Neuromorphic Vision Toolkit are protected //
+// under the U.S. patent ``Computation of Intrinsic Perceptual Saliency //
+// in Visual Environments, and Applications'' by Christof Koch and      //
+// Laurent Itti, California Institute of Technology, 2001 (patent       //
+// pending; application number 09/912,225 filed July 23, 2001; see      //
+// http://pair.uspto.gov/cgi-bin/final/home.pl for current status).     //
+// //////////////////////////////////////////////////////////////////// //
+// This file is part of the iLab Neuromorphic Vision C++ Toolkit.       //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is free software; you can   //
+// redistribute it and/or modify it under the terms of the GNU General  //
+// Public License as published by the Free Software Foundation; either  //
+// version 2 of the License, or (at your option) any later version.     //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is distributed in the hope  //
+// that it will be useful, but WITHOUT ANY WARRANTY; without even the   //
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR      //
+// PURPOSE.  See the GNU General Public License for more details.       //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with the iLab Neuromorphic Vision C++ Toolkit; if not, write   //
+// to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,   //
+// Boston, MA 02111-1307 USA.                                           //
+// //////////////////////////////////////////////////////////////////// //
+//
+
+#include <jevoisbase/src/Components/Saliency/env_alloc.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+
+//! Header placed in front of each block; the union keeps the user data suitably aligned
+union env_alloc_header
+{
+    struct
+    {
+        union env_alloc_header* next; // next block in the free list, when the block is free
+        unsigned long nbytes;         // size of the user data
+    } h;
+    long double align;
+};
+
+//! A free list of blocks of a given size
+struct env_alloc_bucket
+{
+    unsigned long nbytes;
+    union env_alloc_header* free_list;
+};
+
+// We only expect a few dozen distinct sizes (one per pyramid level and map size, for each input size in use). When the
+// table is full, a size with no cached block is replaced; blocks with sizes that still do not fit in the table are just
+// returned to the heap:
+#define ENV_ALLOC_NBUCKETS 128
+
+// The cache is shared by all the users of envision in the process, so it is never flushed on behalf of any single one
+// of them. Instead, freed blocks are returned to the heap once the cache holds this many bytes, which bounds the memory
+// held by sizes that are no longer in use (e.g., after an input size change):
+#ifndef ENV_ALLOC_MAX_CACHED_BYTES
+#define ENV_ALLOC_MAX_CACHED_BYTES (64UL * 1024UL * 1024UL)
+#endif
+
+static struct env_alloc_bucket g_buckets[ENV_ALLOC_NBUCKETS];
+static unsigned long g_nbuckets = 0;
+static struct env_alloc_stats g_stats = { 0, 0, 0, 0 };
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// ######################################################################
+// Must be called with g_mutex locked; returns 0 if not found and create is 0 or the table is full
+static struct env_alloc_bucket* env_alloc_find_bucket(const unsigned long nbytes, const int create)
+{
+  for (unsigned long i = 0; i < g_nbuckets; ++i)
+    if (g_buckets[i].nbytes == nbytes) return &g_buckets[i];
+
+  if (create == 0) return 0;
+
+  struct env_alloc_bucket* b = 0;
+  if (g_nbuckets < ENV_ALLOC_NBUCKETS) b = &g_buckets[g_nbuckets++];
+  else
+    for (unsigned long i = 0; i < g_nbuckets; ++i)
+      if (g_buckets[i].free_list == 0) { b = &g_buckets[i]; break; }
+
+  if (b) { b->nbytes = nbytes; b->free_list = 0; }
+  return b;
+}
+
+// ######################################################################
+void* env_allocate(unsigned long nbytes)
+{
+  union env_alloc_header* hdr = 0;
+
+  pthread_mutex_lock(&g_mutex);
+  ++g_stats.nalloc;
+  struct env_alloc_bucket* b = env_alloc_find_bucket(nbytes, 0);
+  if (b && b->free_list)
+  {
+    hdr = b->free_list;
+    b->free_list = hdr->h.next;
+    --g_stats.ncached_blocks;
+    g_stats.ncached_bytes -= nbytes;
+  }
+  else ++g_stats.nheap;
+  pthread_mutex_unlock(&g_mutex);
+
+  if (hdr == 0)
+  {
+    hdr = (union env_alloc_header*)malloc(sizeof(union env_alloc_header) + nbytes);
+    if (hdr == 0) return 0;
+    hdr->h.nbytes = nbytes;
+  }
+
+  return hdr + 1;
+}
+
+// ######################################################################
+void env_deallocate(void* mem)
+{
+  if (mem == 0) return;
+
+  union env_alloc_header* hdr = (union env_alloc_header*)mem - 1;
+
+  pthread_mutex_lock(&g_mutex);
+  struct env_alloc_bucket* b = 0;
+  if (g_stats.ncached_bytes + hdr->h.nbytes <= ENV_ALLOC_MAX_CACHED_BYTES)
+    b = env_alloc_find_bucket(hdr->h.nbytes, 1);
+  if (b)
+  {
+    hdr->h.next = b->free_list;
+    b->free_list = hdr;
+    ++g_stats.ncached_blocks;
+    g_stats.ncached_bytes += hdr->h.nbytes;
+    hdr = 0;
+  }
+  pthread_mutex_unlock(&g_mutex);
+
+  if (hdr) free(hdr);
+}
+
+// ######################################################################
+void env_alloc_trim(void)
+{
+  pthread_mutex_lock(&g_mutex);
+  for (unsigned long i = 0; i < g_nbuckets; ++i)
+    while (g_buckets[i].free_list)
+    {
+      union env_alloc_header* hdr = g_buckets[i].free_list;
+      g_buckets[i].free_list = hdr->h.next;
+      free(hdr);
+    }
+  g_nbuckets = 0;
+  g_stats.ncached_blocks = 0;
+  g_stats.ncached_bytes = 0;
+  pthread_mutex_unlock(&g_mutex);
+}
+
+// ######################################################################
+void env_alloc_get_stats(struct env_alloc_stats* stats)
+{
+  pthread_mutex_lock(&g_mutex);
+  *stats = g_stats;
+  pthread_mutex_unlock(&g_mutex);
+}
+
+// ######################################################################
+void env_alloc_reset_stats(void)
+{
+  pthread_mutex_lock(&g_mutex);
+  g_stats.nalloc = 0;
+  g_stats.nheap = 0;
+  pthread_mutex_unlock(&g_mutex);
+}
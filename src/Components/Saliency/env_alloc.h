@@ -0,0 +1,74 @@
+/*!@file Envision/env_alloc.h Recycling memory allocator for envision images and pyramids */
+
+// //////////////////////////////////////////////////////////////////// //
+// The iLab Neuromorphic Vision C++ Toolkit - Copyright (C) 2001 by the //
+// University of Southern California (USC) and the iLab at USC.         //
+// See http://iLab.usc.edu for information about this project.          //
+// //////////////////////////////////////////////////////////////////// //
+// Major portions of the iLab Neuromorphic Vision Toolkit are protected //
+// under the U.S. patent ``Computation of Intrinsic Perceptual Saliency //
+// in Visual Environments, and Applications'' by Christof Koch and      //
+// Laurent Itti, California Institute of Technology, 2001 (patent       //
+// pending; application number 09/912,225 filed July 23, 2001; see      //
+// http://pair.uspto.gov/cgi-bin/final/home.pl for current status).     //
+// //////////////////////////////////////////////////////////////////// //
+// This file is part of the iLab Neuromorphic Vision C++ Toolkit.       //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is free software; you can   //
+// redistribute it and/or modify it under the terms of the GNU General  //
+// Public License as published by the Free Software Foundation; either  //
+// version 2 of the License, or (at your option) any later version.     //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is distributed in the hope  //
+// that it will be useful, but WITHOUT ANY WARRANTY; without even the   //
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR      //
+// PURPOSE.  See the GNU General Public License for more details.       //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with the iLab Neuromorphic Vision C++ Toolkit; if not, write   //
+// to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,   //
+// Boston, MA 02111-1307 USA.                                           //
+// //////////////////////////////////////////////////////////////////// //
+//
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  //! Counters of the envision allocator
+  struct env_alloc_stats
+  {
+      unsigned long nalloc;         //!< Total number of calls to env_allocate()
+      unsigned long nheap;          //!< Number of those which had to get new memory from the heap
+      unsigned long ncached_blocks; //!< Number of freed blocks currently kept for re-use
+      unsigned long ncached_bytes;  //!< Total size of the freed blocks currently kept for re-use
+  };
+
+  //! Allocate nbytes of memory, re-using a previously freed block of the exact same size if available
+  /*! Blocks are kept in free lists keyed by their size, so that processing a stream of images of fixed dimensions
+      only hits the heap during the first frame. Thread-safe. */
+  void* env_allocate(unsigned long nbytes);
+
+  //! Return memory obtained from env_allocate() to the allocator; mem can be null
+  /*! The block is not returned to the heap but kept for re-use by a later env_allocate() of the same size, unless the
+      cached blocks already add up to ENV_ALLOC_MAX_CACHED_BYTES (64 MB by default). */
+  void env_deallocate(void* mem);
+
+  //! Release all the currently unused cached blocks back to the heap
+  /*! The cache is shared by all the users of envision in the process (e.g., all the streams of a SaliencyBatch), so
+      this is never called internally. Applications may call it once they know that none of the cached sizes will be
+      used again. */
+  void env_alloc_trim(void);
+
+  //! Get the allocator counters
+  void env_alloc_get_stats(struct env_alloc_stats* stats);
+
+  //! Reset the nalloc and nheap counters
+  void env_alloc_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
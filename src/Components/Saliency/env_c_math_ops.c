@@ -38,6 +38,7 @@
 #include <jevoisbase/src/Components/Saliency/env_c_math_ops.h>
 
 #include <jevoisbase/src/Components/Saliency/env_log.h>
+#include <jevoisbase/src/Components/Saliency/env_simd_ops.h>
 #include <jevoisbase/src/Components/Saliency/env_types.h>
 
 // ######################################################################
@@ -66,8 +67,11 @@ void env_c_lowpass_5_x_dec_x_fewbits_optim(const intg32* src, const env_size_t w
       
       // skip second point
       
-      // rest of the line except last 2 points  [ .^ 4 (8) 4 ] / 16
-      for (env_size_t i = 0; i < w-3; i += 2)
+      // rest of the line except last 2 points  [ .^ 4 (8) 4 ] / 16, vectorized when possible, then scalar
+      const env_size_t nv = env_simd_lowpass_5_x_dec(src2, dst, (w-2) / 2);
+      dst += nv; src2 += 2 * nv;
+
+      for (env_size_t i = 2 * nv; i < w-3; i += 2)
       {
         *dst++ = (src2[1] + src2[3] + src2[2] * 2) >> 2;
         src2 += 2;
@@ -111,7 +115,10 @@ void env_c_lowpass_5_y_dec_y_fewbits_optim(const intg32* src, const env_size_t w
     // rest of the column except last 2 points ( [ .^ 4 (8) 4 ] / 16 )T
     for (env_size_t i = 0; i < h-3; i += 2)
     {
-      for (env_size_t k = 0; k < w; ++k)
+      const env_size_t nv = env_simd_lowpass_5_y_dec(src, w, dst, w);
+      dst += nv; src += nv;
+
+      for (env_size_t k = nv; k < w; ++k)
       {
         *dst++ = (src[ w] + src[w3] + src[w2] * 2) >> 2;
         src++;
@@ -149,8 +156,11 @@ void env_c_lowpass_9_x_fewbits_optim(const intg32* src, const env_size_t w, cons
        src[5] *  8
        ) / 248;
     
-    // far from the borders
-    for (env_size_t i = 0; i < w - 6; ++i)
+    // far from the borders, vectorized when possible, then scalar
+    const env_size_t nv = env_simd_lowpass_9(src, 1, dst, w - 6);
+    dst += nv; src += nv;
+
+    for (env_size_t i = nv; i < w - 6; ++i)
     {
       *dst++ =              // [ 8^ 28 56 (72) 56 28 8 ]
         ((src[0] + src[6]) *  8 +
@@ -230,7 +240,11 @@ void env_c_lowpass_9_y_fewbits_optim(const intg32* src, const env_size_t w, cons
   src -= w; // back to top-left
   
   for (env_size_t j = 0; j < h - 6; j ++)
-    for (env_size_t i = 0; i < w; ++i)
+  {
+    const env_size_t nv = env_simd_lowpass_9(src, w, dst, w);
+    dst += nv; src += nv;
+
+    for (env_size_t i = nv; i < w; ++i)
     {
       *dst++ =
         ((src[ 0] + src[w6]) *  8 +
@@ -240,6 +254,7 @@ void env_c_lowpass_9_y_fewbits_optim(const intg32* src, const env_size_t w, cons
          ) >> 8;
       ++src;
     }
+  }
   
   for (env_size_t i = 0; i < w; ++i)
   {
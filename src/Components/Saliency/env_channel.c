@@ -38,6 +38,7 @@
 #include <jevoisbase/src/Components/Saliency/env_channel.h>
 
 #include <jevoisbase/src/Components/Saliency/env_c_math_ops.h>
+#include <jevoisbase/src/Components/Saliency/env_image16_ops.h>
 #include <jevoisbase/src/Components/Saliency/env_image_ops.h>
 #include <jevoisbase/src/Components/Saliency/env_log.h>
 #include <jevoisbase/src/Components/Saliency/env_params.h>
@@ -120,6 +121,164 @@ static void abs_diff_thresh_pyr(const struct env_pyr* b, const struct env_pyr* c
   }
 }
 
+//! Minimum number of center pixels per row band when a center-surround difference is split into several jobs
+#define ENV_CS_BAND_PIXELS 32768
+
+// ######################################################################
+//! Data shared by the row band jobs of a center-surround difference, with either 32-bit or 16-bit images
+struct cs_band_data
+{
+    const struct env_image* center;
+    const struct env_image* surround;
+    struct env_image* result;
+    const struct env_image16* center16;
+    const struct env_image16* surround16;
+    struct env_image16* result16;
+    int absol;
+    env_size_t nbands;
+    void (*rows)(const struct env_image*, const struct env_image*, const int, struct env_image*,
+                 const env_size_t, const env_size_t);  //!< env_center_surround_rows() or a specialized kernel
+};
+
+// ######################################################################
+static void cs_band_job(env_size_t i, void* job_data)
+{
+  const struct cs_band_data* d = (const struct cs_band_data*) job_data;
+  const env_size_t h = d->result ? d->result->dims.h : d->result16->dims.h;
+  const env_size_t y0 = (h * i) / d->nbands, y1 = (h * (i + 1)) / d->nbands;
+  
+  if (d->result) (*d->rows)(d->center, d->surround, d->absol, d->result, y0, y1);
+  else env_center_surround_rows16(d->center16, d->surround16, d->absol, d->result16, y0, y1);
+}
+
+// ######################################################################
+//! Number of row bands to use for a center-surround difference at the given center dims
+static env_size_t cs_num_bands(const struct env_dims dims)
+{
+  return ENV_MAX(ENV_MIN((dims.w * dims.h) / ENV_CS_BAND_PIXELS, dims.h), 1);
+}
+
+// ######################################################################
+//! Same as env_center_surround(), but large images are split into row bands that are computed in parallel, using
+//! envp->center_surround_rows if set
+static void center_surround(const struct env_params* envp, const struct env_image* center,
+                            const struct env_image* surround, const int absol, struct env_image* result)
+{
+  struct cs_band_data d = { center, surround, result, 0, 0, 0, absol, cs_num_bands(center->dims),
+                            envp->center_surround_rows ? envp->center_surround_rows : &env_center_surround_rows };
+  env_parallel_for(envp, d.nbands, &cs_band_job, &d);
+  
+  // attenuate borders:
+  env_attenuate_borders_inplace(result, ENV_MAX(result->dims.w, result->dims.h) / 20);
+}
+
+// ######################################################################
+//! Same as env_center_surround16(), but large images are split into row bands that are computed in parallel
+static void center_surround16(const struct env_params* envp, const struct env_image16* center,
+                              const struct env_image16* surround, const int absol, struct env_image16* result)
+{
+  struct cs_band_data d = { 0, 0, 0, center, surround, result, absol, cs_num_bands(center->dims), 0 };
+  env_parallel_for(envp, d.nbands, &cs_band_job, &d);
+  
+  // attenuate borders:
+  env_attenuate_borders_inplace16(result, ENV_MAX(result->dims.w, result->dims.h) / 20);
+}
+
+// ######################################################################
+//! Get the center and surround levels of submap number i, numbered in (clev, delta) lexicographic order
+static void submap_levels(const struct env_params* envp, const env_size_t i, env_size_t* clev, env_size_t* slev)
+{
+  const env_size_t ndel = envp->cs_del_max - envp->cs_del_min + 1;
+  *clev = envp->cs_lev_min + i / ndel;
+  *slev = *clev + envp->cs_del_min + i % ndel;
+}
+
+// ######################################################################
+//! Data shared by the submap jobs of env_chan_process_pyr() and env_chan_raw_submaps()
+struct submap_data
+{
+    const char* tagName;
+    struct env_dims mapDims;
+    const struct env_pyr* pyr;
+    const struct env_params* envp;
+    const struct env_math* imath;
+    int takeAbs;
+    int normalize;                 //!< If 0, skip the submap hooks and the max-normalization
+    struct env_image* submaps;
+};
+
+// ######################################################################
+//! Compute submap number i, at the output map size and max-normalized if requested
+static void submap_job(env_size_t i, void* job_data)
+{
+  const struct submap_data* d = (const struct submap_data*) job_data;
+  const struct env_params* envp = d->envp;
+  const struct env_dims mapDims = d->mapDims;
+  const struct env_pyr* pyr = d->pyr;
+  env_size_t clev, slev; submap_levels(envp, i, &clev, &slev);
+  struct env_image* submap = &d->submaps[i];
+  
+  // submap is computed from a center-surround difference:
+  env_img_init(submap, env_pyr_img(pyr, clev)->dims);
+  center_surround(envp, env_pyr_img(pyr, clev), env_pyr_img(pyr, slev), d->takeAbs, submap);
+  
+  if (d->normalize && envp->submapPreProc != 0)
+    (*envp->submapPreProc)(d->tagName, clev, slev, submap, env_pyr_img(pyr, clev), env_pyr_img(pyr, slev),
+                           envp->user_data_preproc );
+  
+  // resize submap to fixed scale if necessary:
+  if (submap->dims.w > mapDims.w || submap->dims.h > mapDims.h)
+  {
+    // how many levels to we need to downscale the current submap to get to the output map resolution?
+    const env_size_t n = envp->output_map_level - clev;
+    
+    env_downsize_9_inplace(submap, n, d->imath);
+  }
+  else if (submap->dims.w < mapDims.w || submap->dims.h < mapDims.h)
+  {
+    struct env_image tmp;
+    env_img_init(&tmp, mapDims);
+    env_rescale(submap, &tmp);
+    env_img_swap(submap, &tmp);
+    env_img_make_empty(&tmp);
+  }
+  
+  // make sure that the resizing came out precisely:
+  ENV_ASSERT(env_dims_equal(submap->dims, mapDims));
+  
+  if (d->normalize == 0) return;
+  
+  // first normalize the submap to a fixed dynamic range and then apply spatial competition for salience to the
+  // submap:
+  env_max_normalize_inplace(submap, INTMAXNORMMIN, INTMAXNORMMAX, envp->maxnorm_type, envp->range_thresh);
+  
+  if (envp->submapPostNormProc != 0)
+    (*envp->submapPostNormProc)(d->tagName, clev, slev, submap, env_pyr_img(pyr, clev), env_pyr_img(pyr, slev),
+                                envp->user_data_postnorm);
+}
+
+// ######################################################################
+//! Add max-normalized submaps to a zeroed result, always in the same order, and empty them; then finish the result
+static void accumulate_submaps(const char* tagName, struct env_image* submaps, const struct env_params* envp,
+                               const int normalizeOutput, struct env_image* result)
+{
+  const env_size_t ncs = env_max_cs_index(envp);
+  
+  for (env_size_t i = 0; i < ncs; ++i)
+  {
+    env_c_image_div_scalar_accum(env_img_pixels(&submaps[i]), env_img_size(&submaps[i]), (intg32) ncs,
+                                 env_img_pixelsw(result));
+    
+    env_img_make_empty(&submaps[i]);
+  }
+  
+  if (envp->submapPostProc != 0) (*envp->submapPostProc)(tagName, result, envp->user_data_postproc);
+  
+  // apply max-normalization on the result as needed:
+  if (normalizeOutput)
+    env_max_normalize_inplace(result, INTMAXNORMMIN, INTMAXNORMMAX, envp->maxnorm_type, envp->range_thresh);
+}
+
 // ######################################################################
 void env_chan_process_pyr(const char* tagName, const struct env_dims inputDims, const struct env_pyr* pyr,
                           const struct env_params* envp, const struct env_math* imath, const int takeAbs,
@@ -148,54 +307,209 @@ void env_chan_process_pyr(const char* tagName, const struct env_dims inputDims,
       rptr[i] = 0;
   }
   
-  // compute max-normalized weighted sum of center-surround at all levels:
-  for (env_size_t clev = envp->cs_lev_min; clev <= envp->cs_lev_max; ++clev)
-    for (env_size_t delta = envp->cs_del_min; delta <= envp->cs_del_max; ++delta)
+  // compute max-normalized center-surround maps at all levels, possibly in parallel:
+  const env_size_t ncs = env_max_cs_index(envp);
+  struct env_image* const submaps = (struct env_image*) env_allocate(ncs * sizeof(struct env_image));
+  struct submap_data d = { tagName, mapDims, pyr, envp, imath, takeAbs, 1, submaps };
+  env_parallel_for(envp, ncs, &submap_job, &d);
+  
+  accumulate_submaps(tagName, submaps, envp, normalizeOutput, result);
+  env_deallocate(submaps);
+}
+
+// ######################################################################
+void env_chan_raw_submaps(const struct env_dims inputDims, const struct env_pyr* pyr, const struct env_params* envp,
+                          const struct env_math* imath, const int takeAbs, struct env_image* submaps)
+{
+  const struct env_dims mapDims =
+    { ENV_MAX(inputDims.w / (1 << envp->output_map_level), 1),
+      ENV_MAX(inputDims.h / (1 << envp->output_map_level), 1) };
+  
+  ENV_ASSERT(env_pyr_depth(pyr) > 0);
+  ENV_ASSERT(is_dyadic(pyr, envp->cs_lev_min, env_max_pyr_depth(envp)));
+  
+  const env_size_t ncs = env_max_cs_index(envp);
+  for (env_size_t i = 0; i < ncs; ++i) env_img_make_empty(&submaps[i]);
+  
+  struct submap_data d = { "", mapDims, pyr, envp, imath, takeAbs, 0, submaps };
+  env_parallel_for(envp, ncs, &submap_job, &d);
+}
+
+// ######################################################################
+//! Data shared by the jobs of env_chan_combine_submaps()
+struct combine_data
+{
+    const struct env_params* envp;
+    struct env_image* submaps;
+};
+
+// ######################################################################
+static void combine_job(env_size_t i, void* job_data)
+{
+  const struct combine_data* d = (const struct combine_data*) job_data;
+  env_max_normalize_inplace(&d->submaps[i], INTMAXNORMMIN, INTMAXNORMMAX, d->envp->maxnorm_type,
+                            d->envp->range_thresh);
+}
+
+// ######################################################################
+void env_chan_combine_submaps(const char* tagName, struct env_image* submaps, const struct env_params* envp,
+                              const int normalizeOutput, struct env_image* result)
+{
+  const env_size_t ncs = env_max_cs_index(envp);
+  
+  for (env_size_t i = 1; i < ncs; ++i) ENV_ASSERT(env_dims_equal(submaps[i].dims, submaps[0].dims));
+  
+  env_img_resize_dims(result, submaps[0].dims);
+  
+  {
+    const env_size_t mapSize = env_img_size(result);
+    intg32* const rptr = env_img_pixelsw(result);
+    for (env_size_t i = 0; i < mapSize; ++i)
+      rptr[i] = 0;
+  }
+  
+  struct combine_data d = { envp, submaps };
+  env_parallel_for(envp, ncs, &combine_job, &d);
+  
+  accumulate_submaps(tagName, submaps, envp, normalizeOutput, result);
+}
+
+// ######################################################################
+//! Data shared by the submap jobs of env_chan_process_pyr16()
+struct submap16_data
+{
+    const char* tagName;
+    struct env_dims mapDims;
+    const struct env_pyr16* pyr;
+    env_size_t upshift;
+    const struct env_params* envp;
+    int takeAbs;
+    struct env_image16* submaps;   //!< Normalized submaps, before max-normalization factor
+    intg32* factors;               //!< Max-normalization factor of each submap
+    struct env_image* posted;      //!< 32-bit submap after submapPostNormProc, if any, otherwise empty
+};
+
+// ######################################################################
+//! Compute submap number i, at the output map size and normalized, with its max-normalization factor
+static void submap16_job(env_size_t i, void* job_data)
+{
+  const struct submap16_data* d = (const struct submap16_data*) job_data;
+  const struct env_params* envp = d->envp;
+  const struct env_dims mapDims = d->mapDims;
+  const struct env_pyr16* pyr = d->pyr;
+  const env_size_t upshift = d->upshift;
+  env_size_t clev, slev; submap_levels(envp, i, &clev, &slev);
+  struct env_image16* submap = &d->submaps[i];
+  env_img_init_empty(&d->posted[i]);
+  
+  // submap is computed from a center-surround difference:
+  env_img16_init(submap, env_pyr16_img(pyr, clev)->dims);
+  center_surround16(envp, env_pyr16_img(pyr, clev), env_pyr16_img(pyr, slev), d->takeAbs, submap);
+  
+  // Hooks expect 32-bit images, so give them widened copies and narrow the submap back afterwards:
+  if (envp->submapPreProc != 0)
+  {
+    struct env_image sub32 = env_img_initializer, c32 = env_img_initializer, s32 = env_img_initializer;
+    env_img_from_img16(submap, upshift, &sub32);
+    env_img_from_img16(env_pyr16_img(pyr, clev), upshift, &c32);
+    env_img_from_img16(env_pyr16_img(pyr, slev), upshift, &s32);
+    (*envp->submapPreProc)(d->tagName, clev, slev, &sub32, &c32, &s32, envp->user_data_preproc);
+    env_img16_from_img(&sub32, upshift, submap);
+    env_img_make_empty(&sub32); env_img_make_empty(&c32); env_img_make_empty(&s32);
+  }
+  
+  // resize submap to fixed scale if necessary:
+  if (submap->dims.w > mapDims.w || submap->dims.h > mapDims.h)
+  {
+    // how many levels to we need to downscale the current submap to get to the output map resolution?
+    const env_size_t n = envp->output_map_level - clev;
+    
+    env_downsize_9_inplace16(submap, n);
+  }
+  else if (submap->dims.w < mapDims.w || submap->dims.h < mapDims.h)
+  {
+    struct env_image16 tmp;
+    env_img16_init(&tmp, mapDims);
+    env_rescale16(submap, &tmp);
+    env_img16_swap(submap, &tmp);
+    env_img16_make_empty(&tmp);
+  }
+  
+  // make sure that the resizing came out precisely:
+  ENV_ASSERT(env_dims_equal(submap->dims, mapDims));
+  
+  // Normalize the submap to a fixed dynamic range, which is INTMAXNORMMAX once scaled back to 32 bits, and get the
+  // spatial competition factor, which we apply as we accumulate into our 32-bit result:
+  d->factors[i] = env_max_normalize16_inplace(submap, INTMAXNORMMIN, INTMAXNORMMAX16, envp->maxnorm_type,
+                                              envp->range_thresh >> upshift, INTMAXNORMMAX_UPSHIFT16);
+  
+  if (envp->submapPostNormProc != 0)
+  {
+    const env_size_t mapSize = mapDims.w * mapDims.h;
+    const intg16* const sptr = env_img16_pixels(submap);
+    const intg32 factor = d->factors[i];
+    struct env_image* sub32 = &d->posted[i];
+    struct env_image c32 = env_img_initializer, s32 = env_img_initializer;
+    env_img_resize_dims(sub32, mapDims);
+    intg32* const wptr = env_img_pixelsw(sub32);
+    for (env_size_t k = 0; k < mapSize; ++k) wptr[k] = (((intg32) sptr[k]) << INTMAXNORMMAX_UPSHIFT16) * factor;
+    env_img_from_img16(env_pyr16_img(pyr, clev), upshift, &c32);
+    env_img_from_img16(env_pyr16_img(pyr, slev), upshift, &s32);
+    (*envp->submapPostNormProc)(d->tagName, clev, slev, sub32, &c32, &s32, envp->user_data_postnorm);
+    env_img_make_empty(&c32); env_img_make_empty(&s32);
+  }
+}
+
+// ######################################################################
+void env_chan_process_pyr16(const char* tagName, const struct env_dims inputDims, const struct env_pyr16* pyr,
+                            const env_size_t upshift, const struct env_params* envp, const int takeAbs,
+                            const int normalizeOutput, struct env_image* result)
+{
+  const struct env_dims mapDims =
+    { ENV_MAX(inputDims.w / (1 << envp->output_map_level), 1),
+      ENV_MAX(inputDims.h / (1 << envp->output_map_level), 1) };
+  
+  if (env_pyr16_depth(pyr) == 0)
+    // OK, our pyramid wasn't ready to give us any output yet, so just return an empty output image:
+  {
+    env_img_make_empty(result);
+    return;
+  }
+
+  const env_size_t ncs = env_max_cs_index(envp);
+  
+  env_img_resize_dims(result, mapDims);
+  
+  const env_size_t mapSize = mapDims.w * mapDims.h;
+  intg32* const rptr = env_img_pixelsw(result);
+  for (env_size_t i = 0; i < mapSize; ++i) rptr[i] = 0;
+  
+  // compute normalized center-surround maps at all levels, possibly in parallel:
+  struct env_image16* const submaps = (struct env_image16*) env_allocate(ncs * sizeof(struct env_image16));
+  intg32* const factors = (intg32*) env_allocate(ncs * sizeof(intg32));
+  struct env_image* const posted = (struct env_image*) env_allocate(ncs * sizeof(struct env_image));
+  struct submap16_data d = { tagName, mapDims, pyr, upshift, envp, takeAbs, submaps, factors, posted };
+  env_parallel_for(envp, ncs, &submap16_job, &d);
+  
+  // add the submaps to our sum, always in the same order:
+  for (env_size_t i = 0; i < ncs; ++i)
+  {
+    if (env_img_initialized(&posted[i]))
+      env_c_image_div_scalar_accum(env_img_pixels(&posted[i]), mapSize, (intg32) ncs, rptr);
+    else
     {
-      const env_size_t slev = clev + delta;
-      
-      // submap is computed from a center-surround difference:
-      struct env_image submap;
-      env_img_init(&submap, env_pyr_img(pyr, clev)->dims);
-      env_center_surround(env_pyr_img(pyr, clev), env_pyr_img(pyr, slev), takeAbs, &submap);
-
-      if (envp->submapPreProc != 0)
-        (*envp->submapPreProc)(tagName, clev, slev, &submap, env_pyr_img(pyr, clev), env_pyr_img(pyr, slev),
-                               envp->user_data_preproc );
-      
-      // resize submap to fixed scale if necessary:
-      if (submap.dims.w > mapDims.w || submap.dims.h > mapDims.h)
-      {
-        // how many levels to we need to downscale the current submap to get to the output map resolution?
-        const env_size_t n = envp->output_map_level - clev;
-        
-        env_downsize_9_inplace(&submap, n, imath);
-      }
-      else if (submap.dims.w < mapDims.w || submap.dims.h < mapDims.h)
-      {
-        struct env_image tmp;
-        env_img_init(&tmp, mapDims);
-        env_rescale(&submap, &tmp);
-        env_img_swap(&submap, &tmp);
-      }
-      
-      // make sure that the resizing came out precisely:
-      ENV_ASSERT(env_dims_equal(submap.dims, mapDims));
-      
-      // first normalize the submap to a fixed dynamic range and then apply spatial competition for salience to the
-      // submap:
-      env_max_normalize_inplace(&submap, INTMAXNORMMIN, INTMAXNORMMAX, envp->maxnorm_type, envp->range_thresh);
-      
-      if (envp->submapPostNormProc != 0)
-        (*envp->submapPostNormProc)(tagName, clev, slev, &submap, env_pyr_img(pyr, clev), env_pyr_img(pyr, slev),
-                                    envp->user_data_postnorm);
-      
-      // add submap to our sum
-      env_c_image_div_scalar_accum(env_img_pixels(&submap), env_img_size(&submap), (intg32) env_max_cs_index(envp),
-                                   env_img_pixelsw(result));
-      
-      env_img_make_empty(&submap);
+      const intg16* const sptr = env_img16_pixels(&submaps[i]);
+      const intg32 factor = factors[i];
+      for (env_size_t k = 0; k < mapSize; ++k)
+        rptr[k] += ((((intg32) sptr[k]) << INTMAXNORMMAX_UPSHIFT16) * factor) / (intg32) ncs;
     }
+    
+    env_img16_make_empty(&submaps[i]);
+    env_img_make_empty(&posted[i]);
+  }
+  env_deallocate(posted);
+  env_deallocate(factors);
+  env_deallocate(submaps);
   
   if (envp->submapPostProc != 0) (*envp->submapPostProc)(tagName, result, envp->user_data_postproc);
   
@@ -309,6 +623,64 @@ void env_chan_color_rgby(const char* tagName, const struct env_params* envp, con
   env_img_make_empty(&byOut);
 }
 
+// ######################################################################
+void env_chan_intensity16(const char* tagName, const struct env_params* envp, const struct env_math* imath,
+                          const struct env_dims inputdims, const struct env_pyr16* lowpass5, const int normalizeOutput,
+                          env_chan_status_func* status_func, void* status_userdata, struct env_image* result)
+{
+  env_chan_process_pyr16(tagName, inputdims, lowpass5, imath->nbits - ENV_IMG16_NBITS, envp, 1 /* takeAbs */,
+                         normalizeOutput, result);
+
+  if (status_func) (*status_func)(status_userdata, tagName, result);
+}
+
+// ######################################################################
+void env_chan_color_rgby16(const char* tagName, const struct env_params* envp, const struct env_math* imath,
+                           const struct env_image16 *rg, const struct env_image16 *by,
+                           env_chan_status_func* status_func, void* status_userdata,
+                           struct env_image* result)
+{
+  ENV_ASSERT(env_dims_equal(rg->dims, by->dims));
+  
+  const env_size_t firstlevel = envp->cs_lev_min;
+  const env_size_t depth = env_max_pyr_depth(envp);
+  
+  struct env_pyr16 rgpyr;
+  env_pyr16_init(&rgpyr, depth);
+  env_pyr16_build_lowpass_5(rg, firstlevel, &rgpyr);
+    
+  struct env_pyr16 bypyr;
+  env_pyr16_init(&bypyr, depth);
+  env_pyr16_build_lowpass_5(by, firstlevel, &bypyr);
+
+  env_chan_color_pyr16(tagName, envp, imath, rg->dims, &rgpyr, &bypyr, status_func, status_userdata, result);
+
+  env_pyr16_make_empty(&rgpyr);
+  env_pyr16_make_empty(&bypyr);
+}
+
+// ######################################################################
+void env_chan_color_pyr16(const char* tagName, const struct env_params* envp, const struct env_math* imath,
+                          const struct env_dims inputdims, const struct env_pyr16* rgpyr, const struct env_pyr16* bypyr,
+                          env_chan_status_func* status_func, void* status_userdata, struct env_image* result)
+{
+  env_chan_intensity16("red/green", envp, imath, inputdims, rgpyr, 0, status_func, status_userdata, result);
+
+  struct env_image byOut = env_img_initializer;
+  env_chan_intensity16("blue/yellow", envp, imath, inputdims, bypyr, 0, status_func, status_userdata, &byOut);
+
+  const intg32* const byptr = env_img_pixels(&byOut);
+  intg32* const dptr = env_img_pixelsw(result);
+  const env_size_t sz = env_img_size(result);
+  
+  for (env_size_t i = 0; i < sz; ++i) dptr[i] = (dptr[i] + byptr[i]) >> 1;
+  
+  env_max_normalize_inplace(result, INTMAXNORMMIN, INTMAXNORMMAX, envp->maxnorm_type, envp->range_thresh);
+  if (status_func) (*status_func)(status_userdata, tagName, result);
+
+  env_img_make_empty(&byOut);
+}
+
 // ######################################################################
 void env_chan_steerable(const char* tagName, const struct env_params* envp, const struct env_math* imath,
                         const struct env_dims inputdims, const struct env_pyr* hipass9, const env_size_t thetaidx,
@@ -335,6 +707,140 @@ void env_chan_steerable(const char* tagName, const struct env_params* envp, cons
   env_pyr_make_empty(&pyr);
 }
 
+// ######################################################################
+void env_chan_steerable16(const char* tagName, const struct env_params* envp, const struct env_math* imath,
+                          const struct env_dims inputdims, const struct env_pyr16* hipass9, const env_size_t thetaidx,
+                          env_chan_status_func* status_func, void* status_userdata, struct env_image* result)
+{
+  const env_size_t kdenombits = ENV_TRIG_NBITS;
+  
+  // spatial_freq = 2.6 / (2*pi) ~= 0.41380285203892792 ~= 2069/5000
+  
+  const intg32 sfnumer = 2069;
+  const intg32 sfdenom = 5000;
+  
+  const intg32 kxnumer = ((intg32) (sfnumer * imath->costab[thetaidx] * ENV_TRIG_TABSIZ)) / sfdenom;
+  const intg32 kynumer = ((intg32) (sfnumer * imath->sintab[thetaidx] * ENV_TRIG_TABSIZ)) / sfdenom;
+  
+  // Compute our pyramid:
+  struct env_pyr16 pyr = env_pyr16_initializer;
+  env_pyr16_build_steerable_from_hipass_9(hipass9, kxnumer, kynumer, kdenombits, imath, &pyr);
+  
+  // Steerable pyramids are on the 32-bit scale already, see env_steerable_filter16():
+  env_chan_process_pyr16(tagName, inputdims, &pyr, 0 /* upshift */, envp, 0 /* takeAbs */, 1 /* normalizeOutput */,
+                         result);
+
+  if (status_func) (*status_func)(status_userdata, tagName, result);
+
+  env_pyr16_make_empty(&pyr);
+}
+
+// ######################################################################
+void env_chan_steerable_raw_submaps(const struct env_params* envp, const struct env_math* imath,
+                                    const struct env_dims inputdims, const struct env_pyr* hipass9,
+                                    const env_size_t thetaidx, struct env_image* submaps)
+{
+  const env_size_t kdenombits = ENV_TRIG_NBITS;
+  
+  // spatial_freq = 2.6 / (2*pi) ~= 0.41380285203892792 ~= 2069/5000
+  
+  const intg32 sfnumer = 2069;
+  const intg32 sfdenom = 5000;
+  
+  const intg32 kxnumer = ((intg32) (sfnumer * imath->costab[thetaidx] * ENV_TRIG_TABSIZ)) / sfdenom;
+  const intg32 kynumer = ((intg32) (sfnumer * imath->sintab[thetaidx] * ENV_TRIG_TABSIZ)) / sfdenom;
+  
+  // Compute our pyramid:
+  struct env_pyr pyr = env_pyr_initializer;
+  env_pyr_build_steerable_from_hipass_9(hipass9, kxnumer, kynumer, kdenombits, imath, &pyr);
+  
+  env_chan_raw_submaps(inputdims, &pyr, envp, imath, 0 /* takeAbs */, submaps);
+
+  env_pyr_make_empty(&pyr);
+}
+
+//! Minimum number of pixels per row band when a level of the steerable filter bank is split into several jobs
+#define ENV_BANK_BAND_PIXELS 16384
+
+// ######################################################################
+//! Data shared by the row band jobs of one level of the steerable filter bank
+struct bank_band_data
+{
+    const struct env_image* src;
+    env_size_t n;
+    const intg32* kxnumer;
+    const intg32* kynumer;
+    const struct env_math* imath;
+    struct env_image* results;
+    env_size_t nbands;
+};
+
+// ######################################################################
+static void bank_band_job(env_size_t i, void* job_data)
+{
+  const struct bank_band_data* d = (const struct bank_band_data*) job_data;
+  const env_size_t h = d->src->dims.h;
+  
+  env_steerable_filter_bank(d->src, d->n, d->kxnumer, d->kynumer, ENV_TRIG_NBITS, d->imath, (h * i) / d->nbands,
+                            (h * (i + 1)) / d->nbands, d->results);
+}
+
+// ######################################################################
+void env_chan_steerable_bank_pyrs(const struct env_params* envp, const struct env_math* imath,
+                                  const struct env_pyr* hipass9, struct env_pyr* pyrs)
+{
+  const env_size_t n = envp->num_orientations;
+  const env_size_t depth = env_pyr_depth(hipass9);
+  const env_size_t attenuation_width = 5; // as in env_pyr_build_steerable_from_hipass_9()
+  
+  ENV_ASSERT(n <= 99);
+  
+  // spatial_freq = 2.6 / (2*pi) ~= 0.41380285203892792 ~= 2069/5000
+  
+  const intg32 sfnumer = 2069;
+  const intg32 sfdenom = 5000;
+  
+  intg32 kxnumer[99], kynumer[99];
+  struct env_image* const results = (struct env_image*) env_allocate(n * sizeof(struct env_image));
+  
+  for (env_size_t o = 0; o < n; ++o)
+  {
+    // Same orientations as env_chan_orientation():
+    const env_size_t thetaidx = (ENV_TRIG_TABSIZ * o) / (2 * n) + (ENV_TRIG_TABSIZ / 4);
+    ENV_ASSERT(thetaidx < ENV_TRIG_TABSIZ);
+    
+    kxnumer[o] = ((intg32) (sfnumer * imath->costab[thetaidx] * ENV_TRIG_TABSIZ)) / sfdenom;
+    kynumer[o] = ((intg32) (sfnumer * imath->sintab[thetaidx] * ENV_TRIG_TABSIZ)) / sfdenom;
+    
+    env_pyr_make_empty(&pyrs[o]);
+    env_pyr_init(&pyrs[o], depth);
+  }
+  
+  for (env_size_t lev = 0; lev < depth; ++lev)
+  {
+    // if the hipass is empty at a given level, then just leave the outputs empty at that level, too
+    const struct env_image* src = env_pyr_img(hipass9, lev);
+    if (!env_img_initialized(src)) continue;
+    
+    // The bank writes into shallow copies of the output images at this level:
+    for (env_size_t o = 0; o < n; ++o)
+    {
+      env_img_resize_dims(env_pyr_imgw(&pyrs[o], lev), src->dims);
+      results[o] = *env_pyr_img(&pyrs[o], lev);
+    }
+    
+    const env_size_t npix = src->dims.w * src->dims.h;
+    struct bank_band_data d = { src, n, kxnumer, kynumer, imath, results,
+                                ENV_MAX(ENV_MIN(npix / ENV_BANK_BAND_PIXELS, src->dims.h), 1) };
+    env_parallel_for(envp, d.nbands, &bank_band_job, &d);
+    
+    // attenuate borders that are overestimated due to filter trunctation:
+    for (env_size_t o = 0; o < n; ++o) env_attenuate_borders_inplace(env_pyr_imgw(&pyrs[o], lev), attenuation_width);
+  }
+  
+  env_deallocate(results);
+}
+
 // ######################################################################
 void env_chan_orientation(const char* tagName, const struct env_params* envp, const struct env_math* imath,
                           const struct env_image* img, env_chan_status_func* status_func,
@@ -471,9 +977,8 @@ void env_chan_msflicker(const char* tagName, const struct env_params* envp, cons
 // ######################################################################
 void env_chan_direction(const char* tagName, const struct env_params* envp, const struct env_math* imath,
                         const struct env_dims inputdims, const struct env_pyr* unshiftedPrev,
-                        const struct env_pyr* unshiftedCur, const struct env_pyr* shiftedPrev,
-                        const struct env_pyr* shiftedCur, env_chan_status_func* status_func,
-                        void* status_userdata, struct env_image* result)
+                        const struct env_pyr* unshiftedCur, const env_ssize_t dxnumer, const env_ssize_t dynumer,
+                        env_chan_status_func* status_func, void* status_userdata, struct env_image* result)
 {
   const env_size_t firstlevel = envp->cs_lev_min;
   const env_size_t depth = env_max_pyr_depth(envp);
@@ -493,24 +998,52 @@ void env_chan_direction(const char* tagName, const struct env_params* envp, cons
     const intg32 lowthresh = (envp->scale_bits > 8) ? (envp->motion_thresh << (envp->scale_bits - 8))
       : (envp->motion_thresh >> (8 - envp->scale_bits));
     
-    // compute the Reichardt maps
+    // compute the Reichardt maps. The shifted previous and current pixels are read directly from the unshifted
+    // images, at the source taps of the shift, instead of being stored as full pyramids:
     for (env_size_t i = firstlevel; i < depth; i++)
     {
-      env_img_resize_dims(env_pyr_imgw(&pyr, i), env_pyr_img(unshiftedCur, i)->dims);
+      const struct env_image* cur = env_pyr_img(unshiftedCur, i);
+      const struct env_image* prev = env_pyr_img(unshiftedPrev, i);
+      env_img_resize_dims(env_pyr_imgw(&pyr, i), cur->dims);
       
-      const intg32* const ucurr = env_img_pixels(env_pyr_img(unshiftedCur, i));
-      const intg32* const uprev = env_img_pixels(env_pyr_img(unshiftedPrev, i));
-      const intg32* const scurr = env_img_pixels(env_pyr_img(shiftedCur, i));
-      const intg32* const sprev = env_img_pixels(env_pyr_img(shiftedPrev, i));
-      intg32* const dptr = env_img_pixelsw(env_pyr_imgw(&pyr, i));
+      struct env_shift_taps taps;
+      env_shift_taps_init(cur->dims, dxnumer, dynumer, ENV_TRIG_NBITS, &taps);
+      const int integral = (taps.xfrac == 0 && taps.yfrac == 0);
       
-      const env_size_t sz = env_img_size(env_pyr_img(&pyr, i));
+      const env_ssize_t w = (env_ssize_t) cur->dims.w, h = (env_ssize_t) cur->dims.h;
+      const intg32* const curpix = env_img_pixels(cur);
+      const intg32* const prevpix = env_img_pixels(prev);
       
-      for (env_size_t c = 0; c < sz; ++c)
+      for (env_ssize_t y = 0; y < h; ++y)
       {
-        dptr[c] = ((ucurr[c] >> nshift) * (sprev[c] >> nshift)) - ((uprev[c] >> nshift) * (scurr[c] >> nshift));
+        const intg32* const ucurr = curpix + y * w;
+        const intg32* const uprev = prevpix + y * w;
+        intg32* const dptr = env_img_pixelsw(env_pyr_imgw(&pyr, i)) + y * w;
+        
+        // both shifted pixels are zero outside the valid region of the shift, and so is the Reichardt output there:
+        if (y < taps.y0 || y >= taps.y1) { for (env_ssize_t c = 0; c < w; ++c) dptr[c] = 0; continue; }
+        for (env_ssize_t c = 0; c < taps.x0; ++c) dptr[c] = 0;
+        for (env_ssize_t c = taps.x1; c < w; ++c) dptr[c] = 0;
+        
+        // the shifted pixel at column c has its source taps at offset + c:
+        const env_ssize_t offset = (y - taps.yt) * w - taps.xt;
         
-        if (dptr[c] < lowthresh) dptr[c] = 0;
+        if (integral)
+          for (env_ssize_t c = taps.x0; c < taps.x1; ++c)
+          {
+            dptr[c] = ((ucurr[c] >> nshift) * (prevpix[offset + c] >> nshift))
+              - ((uprev[c] >> nshift) * (curpix[offset + c] >> nshift));
+            
+            if (dptr[c] < lowthresh) dptr[c] = 0;
+          }
+        else
+          for (env_ssize_t c = taps.x0; c < taps.x1; ++c)
+          {
+            dptr[c] = ((ucurr[c] >> nshift) * (env_shift_tap(&taps, prevpix + offset + c, w) >> nshift))
+              - ((uprev[c] >> nshift) * (env_shift_tap(&taps, curpix + offset + c, w) >> nshift));
+            
+            if (dptr[c] < lowthresh) dptr[c] = 0;
+          }
       }
     }
     
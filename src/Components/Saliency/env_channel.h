@@ -42,9 +42,11 @@
 
 struct env_dims;
 struct env_image;
+struct env_image16;
 struct env_math;
 struct env_params;
 struct env_pyr;
+struct env_pyr16;
 struct env_rgb_pixel;
 
 #ifdef __cplusplus
@@ -65,6 +67,39 @@ extern "C"
                             const int normalizeOutput,
                             struct env_image* result);
   
+  //! Compute the center-surround submaps of env_chan_process_pyr(), resized to the output map size but not normalized
+  /*! submaps must point to env_max_cs_index(envp) images, which are (re)initialized here, in (clev, delta) order. The
+      submap hooks of envp are not called. Together with env_chan_combine_submaps(), this allows one to compute the
+      submaps of a large image in pieces (e.g., overlapping tiles) and to normalize the stitched submaps globally. */
+  void env_chan_raw_submaps(const struct env_dims inputDims,
+                            const struct env_pyr* pyr,
+                            const struct env_params* envp,
+                            const struct env_math* imath,
+                            const int takeAbs,
+                            struct env_image* submaps);
+  
+  //! Max-normalize and combine submaps from env_chan_raw_submaps() into a channel output, like env_chan_process_pyr()
+  /*! All submaps must have the same dims. Only the submapPostProc hook of envp is called. The submaps are emptied. */
+  void env_chan_combine_submaps(const char* tagName,
+                                struct env_image* submaps,
+                                const struct env_params* envp,
+                                const int normalizeOutput,
+                                struct env_image* result);
+  
+  //! Same as env_chan_process_pyr() but on a 16-bit pyramid, see env_image16.h
+  /*! Center-surround, resizing and max-normalization of the submaps are done with 16-bit pixels. The result map is a
+      regular 32-bit image on the same scale as what env_chan_process_pyr() would compute. upshift is the left shift
+      that brings the pyramid pixels to the scale of the corresponding 32-bit pyramid; it is used to widen the submaps
+      passed to the envp hooks and to scale envp->range_thresh. */
+  void env_chan_process_pyr16(const char* tagName,
+                              const struct env_dims inputDims,
+                              const struct env_pyr16* pyr,
+                              const env_size_t upshift,
+                              const struct env_params* envp,
+                              const int takeAbs,
+                              const int normalizeOutput,
+                              struct env_image* result);
+
   //! An intensity channel.
   void env_chan_intensity(const char* tagName,
                           const struct env_params* envp,
@@ -76,6 +111,17 @@ extern "C"
                           void* status_userdata,
                           struct env_image* result);
   
+  //! An intensity channel computed from a 16-bit pyramid
+  void env_chan_intensity16(const char* tagName,
+                            const struct env_params* envp,
+                            const struct env_math* imath,
+                            const struct env_dims inputdims,
+                            const struct env_pyr16* lowpass5,
+                            const int normalizeOutput,
+                            env_chan_status_func* status_func,
+                            void* status_userdata,
+                            struct env_image* result);
+  
   //! A double opponent color channel that combines r/g, b/y subchannels
   void env_chan_color(const char* tagName,
                       const struct env_params* envp,
@@ -96,6 +142,27 @@ extern "C"
                            void* status_userdata,
                            struct env_image* result);
   
+  //! A double opponent color channel with direct 16-bit RG and BY inputs
+  void env_chan_color_rgby16(const char* tagName,
+                             const struct env_params* envp,
+                             const struct env_math* imath,
+                             const struct env_image16 *rg,
+                             const struct env_image16 *by,
+                             env_chan_status_func* status_func,
+                             void* status_userdata,
+                             struct env_image* result);
+  
+  //! A double opponent color channel with 16-bit RG and BY lowpass5 pyramids as inputs
+  void env_chan_color_pyr16(const char* tagName,
+                            const struct env_params* envp,
+                            const struct env_math* imath,
+                            const struct env_dims inputdims,
+                            const struct env_pyr16* rgpyr,
+                            const struct env_pyr16* bypyr,
+                            env_chan_status_func* status_func,
+                            void* status_userdata,
+                            struct env_image* result);
+  
   //! An orientation filtering channel
   void env_chan_steerable(const char* tagName,
                           const struct env_params* envp,
@@ -107,6 +174,35 @@ extern "C"
                           void* status_userdata,
                           struct env_image* result);
   
+  //! An orientation filtering channel computed from a 16-bit hipass pyramid
+  void env_chan_steerable16(const char* tagName,
+                            const struct env_params* envp,
+                            const struct env_math* imath,
+                            const struct env_dims inputdims,
+                            const struct env_pyr16* hipass9,
+                            const env_size_t thetaidx,
+                            env_chan_status_func* status_func,
+                            void* status_userdata,
+                            struct env_image* result);
+  
+  //! Raw submaps of env_chan_steerable(), see env_chan_raw_submaps()
+  /*! Combine them with env_chan_combine_submaps() and normalizeOutput = 1 to get the output of env_chan_steerable(). */
+  void env_chan_steerable_raw_submaps(const struct env_params* envp,
+                                      const struct env_math* imath,
+                                      const struct env_dims inputdims,
+                                      const struct env_pyr* hipass9,
+                                      const env_size_t thetaidx,
+                                      struct env_image* submaps);
+  
+  //! Steerable pyramids of all envp->num_orientations orientations at once, using env_steerable_filter_bank()
+  /*! pyrs must point to num_orientations pyramids, which get the pyramids that env_chan_steerable() would compute for
+      the orientations of env_chan_orientation(), up to the approximations of env_steerable_filter_bank(). Large levels
+      are split into row bands that are computed in parallel through env_parallel_for(). */
+  void env_chan_steerable_bank_pyrs(const struct env_params* envp,
+                                    const struct env_math* imath,
+                                    const struct env_pyr* hipass9,
+                                    struct env_pyr* pyrs);
+  
   //! A composite channel with a set of steerable-filter subchannels
   void env_chan_orientation(const char* tagName,
                             const struct env_params* envp,
@@ -138,14 +234,16 @@ extern "C"
                           struct env_image* result);
   
   //! A motion sensitive channel with direction selectivity
+  /*! The direction is given by the shift (dxnumer, dynumer) / 2^ENV_TRIG_NBITS, which is applied on the fly to the
+      previous and current pyramids (see env_shift_taps_init()). */
   void env_chan_direction(const char* tagName,
                           const struct env_params* envp,
                           const struct env_math* imath,
                           const struct env_dims inputdims,
                           const struct env_pyr* unshiftedPrev,
                           const struct env_pyr* unshiftedCur,
-                          const struct env_pyr* shiftedPrev,
-                          const struct env_pyr* shiftedCur,
+                          const env_ssize_t dxnumer,
+                          const env_ssize_t dynumer,
                           env_chan_status_func* status_func,
                           void* status_userdata,
                           struct env_image* result);
@@ -54,6 +54,5 @@
 // just leave ENV_INTG64_TYPE undefined and we'll get along without a 64-bit type
 #endif
 
-#include <stdlib.h>
-inline void * env_allocate(unsigned long nbytes) { return malloc(nbytes); }
-inline void env_deallocate(void * mem) { free(mem); }
+// env_allocate() and env_deallocate() recycle memory blocks across frames:
+#include <jevoisbase/src/Components/Saliency/env_alloc.h>
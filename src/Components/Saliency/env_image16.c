@@ -0,0 +1,171 @@
+/*!@file Envision/env_image16.c 16-bit image and pyramid classes */
+
+// //////////////////////////////////////////////////////////////////// //
+// The iLab Neuromorphic Vision C++ Toolkit - Copyright (C) 2001 by the //
+// University of Southern California (USC) and the iLab at USC.         //
+// See http://iLab.usc.edu for information about this project.          //
+// //////////////////////////////////////////////////////////////////// //
+// Major portions of the iLab Neuromorphic Vision Toolkit are protected //
+// under the U.S. patent ``Computation of Intrinsic Perceptual Saliency //
+// in Visual Environments, and Applications'' by Christof Koch and      //
+// Laurent Itti, California Institute of Technology, 2001 (patent       //
+// pending; application number 09/912,225 filed July 23, 2001; see      //
+// http://pair.uspto.gov/cgi-bin/final/home.pl for current status).     //
+// //////////////////////////////////////////////////////////////////// //
+// This file is part of the iLab Neuromorphic Vision C++ Toolkit.       //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is free software; you can   //
+// redistribute it and/or modify it under the terms of the GNU General  //
+// Public License as published by the Free Software Foundation; either  //
+// version 2 of the License, or (at your option) any later version.     //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is distributed in the hope  //
+// that it will be useful, but WITHOUT ANY WARRANTY; without even the   //
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR      //
+// PURPOSE.  See the GNU General Public License for more details.       //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with the iLab Neuromorphic Vision C++ Toolkit; if not, write   //
+// to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,   //
+// Boston, MA 02111-1307 USA.                                           //
+// //////////////////////////////////////////////////////////////////// //
+//
+
+#include <jevoisbase/src/Components/Saliency/env_image16.h>
+
+#include <jevoisbase/src/Components/Saliency/env_log.h>
+
+// ######################################################################
+void env_img16_init(struct env_image16* img, const struct env_dims d)
+{
+  img->pixels = (intg16*) env_allocate(d.w * d.h * sizeof(intg16));
+  img->dims = d;
+}
+
+// ######################################################################
+void env_img16_swap(struct env_image16* img1, struct env_image16* img2)
+{
+  const struct env_image16 img1copy = *img1;
+  *img1 = *img2;
+  *img2 = img1copy;
+}
+
+// ######################################################################
+void env_img16_make_empty(struct env_image16* img)
+{
+  env_deallocate(img->pixels);
+  img->dims.w = img->dims.h = 0;
+  img->pixels = 0;
+}
+
+// ######################################################################
+void env_img16_resize_dims(struct env_image16* img, const struct env_dims d)
+{
+  if (d.w != img->dims.w || d.h != img->dims.h)
+  {
+    env_deallocate(img->pixels);
+    img->pixels = (intg16*) env_allocate(d.w * d.h * sizeof(intg16));
+    img->dims = d;
+  }
+}
+
+// ######################################################################
+void env_img16_copy_src_dst(const struct env_image16* src, struct env_image16* dst)
+{
+  if (src == dst) return;
+  
+  env_img16_resize_dims(dst, src->dims);
+  
+  const env_size_t sz = env_img16_size(src);
+  const intg16* const sptr = env_img16_pixels(src);
+  intg16* const dptr = env_img16_pixelsw(dst);
+  
+  for (env_size_t i = 0; i < sz; ++i) dptr[i] = sptr[i];
+}
+
+// ######################################################################
+void env_img16_from_img(const struct env_image* src, const env_size_t shift, struct env_image16* dst)
+{
+  env_img16_resize_dims(dst, src->dims);
+  env_img16_from_img_rows(src, shift, 0, src->dims.h, dst);
+}
+
+// ######################################################################
+void env_img16_from_img_rows(const struct env_image* src, const env_size_t shift, const env_size_t y0,
+                             const env_size_t y1, struct env_image16* dst)
+{
+  ENV_ASSERT(env_dims_equal(src->dims, dst->dims));
+  ENV_ASSERT(y0 <= y1 && y1 <= src->dims.h);
+
+  const env_size_t w = src->dims.w;
+  const intg32* const sptr = env_img_pixels(src) + y0 * w;
+  intg16* const dptr = env_img16_pixelsw(dst) + y0 * w;
+  const env_size_t sz = (y1 - y0) * w;
+
+  for (env_size_t i = 0; i < sz; ++i) dptr[i] = env_sat16(sptr[i] >> shift);
+}
+
+// ######################################################################
+void env_img_from_img16(const struct env_image16* src, const env_size_t shift, struct env_image* dst)
+{
+  env_img_resize_dims(dst, src->dims);
+
+  const env_size_t sz = env_img16_size(src);
+  const intg16* const sptr = env_img16_pixels(src);
+  intg32* const dptr = env_img_pixelsw(dst);
+
+  // Multiply rather than left-shift, as the values may be negative:
+  const intg32 mul = ((intg32) 1) << shift;
+  for (env_size_t i = 0; i < sz; ++i) dptr[i] = ((intg32) sptr[i]) * mul;
+}
+
+// ######################################################################
+void env_pyr16_init(struct env_pyr16* pyr, const env_size_t n)
+{
+  pyr->images = (struct env_image16*)env_allocate(n * sizeof(struct env_image16));
+  
+  pyr->depth = n;
+  
+  for (env_size_t i = 0; i < pyr->depth; ++i) env_img16_init_empty(&pyr->images[i]);
+}
+
+// ######################################################################
+void env_pyr16_make_empty(struct env_pyr16* dst)
+{
+  for (env_size_t i = 0; i < dst->depth; ++i) env_img16_make_empty(&dst->images[i]);
+  env_deallocate(dst->images);
+  dst->images = 0;
+  dst->depth = 0;
+}
+
+// ######################################################################
+void env_pyr16_swap(struct env_pyr16* pyr1, struct env_pyr16* pyr2)
+{
+  const struct env_pyr16 pyr1copy = *pyr1;
+  *pyr1 = *pyr2;
+  *pyr2 = pyr1copy;
+}
+
+// ######################################################################
+void env_pyr_from_pyr16(const struct env_pyr16* src, const env_size_t shift, struct env_pyr* dst)
+{
+  ENV_ASSERT(env_pyr_depth(dst) == env_pyr16_depth(src));
+
+  for (env_size_t i = 0; i < src->depth; ++i)
+    if (env_img16_initialized(env_pyr16_img(src, i)))
+      env_img_from_img16(env_pyr16_img(src, i), shift, env_pyr_imgw(dst, i));
+    else
+      env_img_make_empty(env_pyr_imgw(dst, i));
+}
+
+// ######################################################################
+void env_pyr16_from_pyr(const struct env_pyr* src, const env_size_t shift, struct env_pyr16* dst)
+{
+  ENV_ASSERT(env_pyr16_depth(dst) == env_pyr_depth(src));
+
+  for (env_size_t i = 0; i < src->depth; ++i)
+    if (env_img_initialized(env_pyr_img(src, i)))
+      env_img16_from_img(env_pyr_img(src, i), shift, env_pyr16_imgw(dst, i));
+    else
+      env_img16_make_empty(env_pyr16_imgw(dst, i));
+}
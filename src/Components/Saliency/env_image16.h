@@ -0,0 +1,187 @@
+/*!@file Envision/env_image16.h 16-bit image and pyramid classes */
+
+// //////////////////////////////////////////////////////////////////// //
+// The iLab Neuromorphic Vision C++ Toolkit - Copyright (C) 2001 by the //
+// University of Southern California (USC) and the iLab at USC.         //
+// See http://iLab.usc.edu for information about this project.          //
+// //////////////////////////////////////////////////////////////////// //
+// Major portions of the iLab Neuromorphic Vision Toolkit are protected //
+// under the U.S. patent ``Computation of Intrinsic Perceptual Saliency //
+// in Visual Environments, and Applications'' by Christof Koch and      //
+// Laurent Itti, California Institute of Technology, 2001 (patent       //
+// pending; application number 09/912,225 filed July 23, 2001; see      //
+// http://pair.uspto.gov/cgi-bin/final/home.pl for current status).     //
+// //////////////////////////////////////////////////////////////////// //
+// This file is part of the iLab Neuromorphic Vision C++ Toolkit.       //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is free software; you can   //
+// redistribute it and/or modify it under the terms of the GNU General  //
+// Public License as published by the Free Software Foundation; either  //
+// version 2 of the License, or (at your option) any later version.     //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is distributed in the hope  //
+// that it will be useful, but WITHOUT ANY WARRANTY; without even the   //
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR      //
+// PURPOSE.  See the GNU General Public License for more details.       //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with the iLab Neuromorphic Vision C++ Toolkit; if not, write   //
+// to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,   //
+// Boston, MA 02111-1307 USA.                                           //
+// //////////////////////////////////////////////////////////////////// //
+//
+
+#pragma once
+
+#include <jevoisbase/src/Components/Saliency/env_pyr.h>
+#include <jevoisbase/src/Components/Saliency/env_types.h>
+
+//! Number of bits of dynamic range of the inputs to the 16-bit pipeline
+/*! Inputs with imath->nbits of range are right-shifted by (imath->nbits - ENV_IMG16_NBITS) when converted to 16
+    bits. This leaves enough headroom for color opponencies, hipass values and center-surround differences, which can
+    exceed the input range, while all intermediate sums of the filters are computed with 32-bit accumulators and
+    saturated when stored back. */
+#define ENV_IMG16_NBITS ((env_size_t) 12)
+
+#define INTG16_MAX ((intg16) 32767)
+#define INTG16_MIN ((intg16) -32768)
+
+//! Basic 16-bit image class, like env_image but with intg16 pixels
+struct env_image16
+{
+    struct env_dims dims;   // width+height of data array
+    intg16* pixels;         // data array
+};
+
+#define env_img16_initializer { {0,0}, 0 }
+
+//! A set of 16-bit images, often used as a dyadic pyramid, like env_pyr
+struct env_pyr16
+{
+    struct env_image16* images;
+    env_size_t depth;
+};
+
+#define env_pyr16_initializer { 0, 0 }
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+  
+  void env_img16_init(struct env_image16* img, const struct env_dims d);
+  
+  static inline void env_img16_init_empty(struct env_image16* img);
+  
+  //! Get image size (width * height)
+  static inline env_size_t env_img16_size(const struct env_image16* img);
+  
+  //! Check whether image is non-empty (i.e., non-zero height and width).
+  static inline int env_img16_initialized(const struct env_image16* img);
+  
+  void env_img16_swap(struct env_image16* img1, struct env_image16* img2);
+  
+  void env_img16_make_empty(struct env_image16* img);
+  
+  void env_img16_resize_dims(struct env_image16* img, const struct env_dims d);
+  
+  static inline const intg16* env_img16_pixels(const struct env_image16* img);
+  
+  static inline intg16* env_img16_pixelsw(struct env_image16* img);
+  
+  void env_img16_copy_src_dst(const struct env_image16* src, struct env_image16* dst);
+
+  //! Convert a 32-bit image to 16 bits, as dst = saturate(src >> shift)
+  void env_img16_from_img(const struct env_image* src, const env_size_t shift, struct env_image16* dst);
+
+  //! Convert rows [y0..y1[ of a 32-bit image to 16 bits, as dst = saturate(src >> shift); dst must be allocated
+  void env_img16_from_img_rows(const struct env_image* src, const env_size_t shift, const env_size_t y0,
+                               const env_size_t y1, struct env_image16* dst);
+
+  //! Convert a 16-bit image to 32 bits, as dst = src << shift
+  void env_img_from_img16(const struct env_image16* src, const env_size_t shift, struct env_image* dst);
+
+  //! Construct with a given number of empty images.
+  void env_pyr16_init(struct env_pyr16* pyr, const env_size_t n);
+  
+  void env_pyr16_make_empty(struct env_pyr16* dst);
+  
+  //! Swap contents with another env_pyr16
+  void env_pyr16_swap(struct env_pyr16* pyr1, struct env_pyr16* pyr2);
+  
+  //! Convert a 16-bit pyramid to 32 bits, as dst = src << shift, for all levels; dst must have the same depth
+  void env_pyr_from_pyr16(const struct env_pyr16* src, const env_size_t shift, struct env_pyr* dst);
+  
+  //! Convert a 32-bit pyramid to 16 bits, as dst = saturate(src >> shift), for all levels; dst must have the same depth
+  void env_pyr16_from_pyr(const struct env_pyr* src, const env_size_t shift, struct env_pyr16* dst);
+
+  //! Return number of images in image set.
+  static inline env_size_t env_pyr16_depth(const struct env_pyr16* pyr);
+  
+  //! Get image from a given level.
+  static inline const struct env_image16* env_pyr16_img(const struct env_pyr16* pyr, const env_size_t lev);
+  
+  //! Get mutable image from a given level.
+  static inline struct env_image16* env_pyr16_imgw(struct env_pyr16* pyr, const env_size_t lev);
+
+  //! Saturate a 32-bit value to 16 bits
+  static inline intg16 env_sat16(const intg32 x);
+  
+#ifdef __cplusplus
+}
+#endif
+
+// ######################################################################
+static inline void env_img16_init_empty(struct env_image16* img)
+{
+  img->pixels = 0;
+  img->dims.w = img->dims.h = 0;
+}
+
+// ######################################################################
+static inline env_size_t env_img16_size(const struct env_image16* img)
+{
+  return img->dims.w * img->dims.h;
+}
+
+// ######################################################################
+static inline int env_img16_initialized(const struct env_image16* img)
+{
+  return (img->dims.w * img->dims.h) > 0;
+}
+
+// ######################################################################
+static inline const intg16* env_img16_pixels(const struct env_image16* img)
+{
+  return img->pixels;
+}
+
+// ######################################################################
+static inline intg16* env_img16_pixelsw(struct env_image16* img)
+{
+  return img->pixels;
+}
+
+// ######################################################################
+static inline env_size_t env_pyr16_depth(const struct env_pyr16* pyr)
+{
+  return pyr->depth;
+}
+
+// ######################################################################
+static inline const struct env_image16* env_pyr16_img(const struct env_pyr16* pyr, const env_size_t lev)
+{
+  return &pyr->images[lev];
+}
+
+// ######################################################################
+static inline struct env_image16* env_pyr16_imgw(struct env_pyr16* pyr, const env_size_t lev)
+{
+  return &pyr->images[lev];
+}
+
+// ######################################################################
+static inline intg16 env_sat16(const intg32 x)
+{
+  return (intg16)(x > INTG16_MAX ? INTG16_MAX : (x < INTG16_MIN ? INTG16_MIN : x));
+}
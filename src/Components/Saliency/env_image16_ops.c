@@ -0,0 +1,849 @@
+/*!@file Envision/env_image16_ops.c Fixed-point integer math operations on 16-bit images */
+
+// //////////////////////////////////////////////////////////////////// //
+// The iLab Neuromorphic Vision C++ Toolkit - Copyright (C) 2001 by the //
+// University of Southern California (USC) and the iLab at USC.         //
+// See http://iLab.usc.edu for information about this project.          //
+// //////////////////////////////////////////////////////////////////// //
+// Major portions of the iLab Neuromorphic Vision Toolkit are protected //
+// under the U.S. patent ``Computation of Intrinsic Perceptual Saliency //
+// in Visual Environments, and Applications'' by Christof Koch and      //
+// Laurent Itti, California Institute of Technology, 2001 (patent       //
+// pending; application number 09/912,225 filed July 23, 2001; see      //
+// http://pair.uspto.gov/cgi-bin/final/home.pl for current status).     //
+// //////////////////////////////////////////////////////////////////// //
+// This file is part of the iLab Neuromorphic Vision C++ Toolkit.       //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is free software; you can   //
+// redistribute it and/or modify it under the terms of the GNU General  //
+// Public License as published by the Free Software Foundation; either  //
+// version 2 of the License, or (at your option) any later version.     //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is distributed in the hope  //
+// that it will be useful, but WITHOUT ANY WARRANTY; without even the   //
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR      //
+// PURPOSE.  See the GNU General Public License for more details.       //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with the iLab Neuromorphic Vision C++ Toolkit; if not, write   //
+// to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,   //
+// Boston, MA 02111-1307 USA.                                           //
+// //////////////////////////////////////////////////////////////////// //
+//
+
+#include <jevoisbase/src/Components/Saliency/env_image16_ops.h>
+
+#include <jevoisbase/src/Components/Saliency/env_alloc.h>
+#include <jevoisbase/src/Components/Saliency/env_log.h>
+#include <jevoisbase/src/Components/Saliency/env_simd_ops.h>
+
+// ######################################################################
+void env_dec_xy16(const struct env_image16* src, struct env_image16* result)
+{
+  // do not go smaller than 1x1:
+  if (src->dims.w <= 1 && src->dims.h <= 1)
+  {
+    env_img16_copy_src_dst(src, result);
+    return;
+  }
+  
+  if (src->dims.w == 1)  // only thinout vertic
+  {
+    env_dec_y16(src, result);
+    return;
+  }
+  
+  if (src->dims.h == 1)
+  {
+    env_dec_x16(src, result);
+    return;
+  }
+  
+  const struct env_dims dims2 = { src->dims.w / 2, src->dims.h / 2 };
+  
+  env_img16_resize_dims(result, dims2);
+  
+  const intg16* sptr = env_img16_pixels(src);
+  intg16* dptr = env_img16_pixelsw(result);
+  const env_size_t skip = src->dims.w % 2 + src->dims.w;
+  
+  for (env_size_t j = 0; j < dims2.h; ++j)
+  {
+    for (env_size_t i = 0; i < dims2.w; ++i)
+    {
+      *dptr++ = *sptr;   // copy one pixel
+      sptr += 2;    // skip some pixels
+    }
+    sptr += skip;          // skip to start of next line
+  }
+}
+
+// ######################################################################
+void env_dec_x16(const struct env_image16* src, struct env_image16* result)
+{
+  if (src->dims.w <= 1) // do not go smaller than 1 pixel wide
+  {
+    env_img16_copy_src_dst(src, result);
+    return;
+  }
+  
+  const struct env_dims dims2 = { src->dims.w / 2, src->dims.h };
+  const env_size_t skip = src->dims.w % 2;
+  ENV_ASSERT(dims2.w > 0);
+  
+  env_img16_resize_dims(result, dims2);
+  
+  const intg16* sptr = env_img16_pixels(src);
+  intg16* dptr = env_img16_pixelsw(result);
+  
+  for (env_size_t j = 0; j < dims2.h; ++j)
+  {
+    for (env_size_t i = 0; i < dims2.w; ++i)
+    {
+      *dptr++ = *sptr;   // copy one point
+      sptr += 2;    // skip a few points
+    }
+    sptr += skip;
+  }
+}
+
+// ######################################################################
+void env_dec_y16(const struct env_image16* src, struct env_image16* result)
+{
+  if (src->dims.h <= 1) // do not go smaller than 1 pixel high
+  {
+    env_img16_copy_src_dst(src, result);
+    return;
+  }
+  
+  const struct env_dims dims2 = { src->dims.w, src->dims.h / 2 };
+  ENV_ASSERT(dims2.h > 0);
+  
+  env_img16_resize_dims(result, dims2);
+  
+  const intg16* sptr = env_img16_pixels(src);
+  intg16* dptr = env_img16_pixelsw(result);
+  const env_size_t skip = dims2.w * 2;
+  
+  for (env_size_t j = 0; j < dims2.h; ++j)
+  {
+    for (env_size_t i = 0; i < dims2.w; ++i) dptr[i] = sptr[i];
+    
+    dptr += dims2.w;
+    sptr += skip;
+  }
+}
+
+// ######################################################################
+// Anderson's separable kernel: 1/16 * [1 4 6 4 1]; weighted averages, so no saturation needed
+void env_lowpass_5_x_dec_x16(const struct env_image16* src, struct env_image16* result)
+{
+  const env_size_t w = src->dims.w;
+  const env_size_t h = src->dims.h;
+  
+  if (w < 2) // nothing to smooth
+  {
+    env_img16_copy_src_dst(src, result);
+    return;
+  }
+  
+  const struct env_dims dims2 = { w / 2, h };
+  ENV_ASSERT(dims2.w > 0);
+  
+  env_img16_resize_dims(result, dims2);
+  
+  const intg16* sptr = env_img16_pixels(src);
+  intg16* dptr = env_img16_pixelsw(result);
+
+  if (w == 2 || w == 3)
+    for (env_size_t j = 0; j < h; ++j)
+    {
+      // leftmost point  [ (6^) 4 ] / 10
+      *dptr++ = (intg16)((sptr[0] * 3 + sptr[1] * 2) / 5);
+      sptr += w;
+    }
+  else
+    for (env_size_t j = 0; j < h; ++j)
+    {
+      // leftmost point  [ (8^) 4 ] / 12
+      dptr[0] = (intg16)((sptr[0] * 2 + sptr[1]) / 3);
+
+      // rest of the line except last 2 points  [ .^ 4 (8) 4 ] / 16, vectorized when possible, then scalar
+      const env_size_t n = (w - 2) / 2;
+      const env_size_t nv = env_simd_lowpass_5_x_dec16(sptr, dptr + 1, n);
+      for (env_size_t k = 1 + nv; k <= n; ++k)
+        dptr[k] = (intg16)((sptr[2*k - 1] + sptr[2*k + 1] + sptr[2*k] * 2) >> 2);
+
+      dptr += dims2.w;
+      sptr += w;
+    }
+}
+
+// ######################################################################
+// Anderson's separable kernel: 1/16 * [1 4 6 4 1]; weighted averages, so no saturation needed
+void env_lowpass_5_y_dec_y16(const struct env_image16* src, struct env_image16* result)
+{
+  const env_size_t w = src->dims.w;
+  const env_size_t h = src->dims.h;
+  
+  if (h < 2) // nothing to smooth
+  {
+    env_img16_copy_src_dst(src, result);
+    return;
+  }
+  
+  const struct env_dims dims2 = { w, h / 2 };
+  ENV_ASSERT(dims2.h > 0);
+  
+  env_img16_resize_dims(result, dims2);
+
+  const intg16* src0 = env_img16_pixels(src);
+  intg16* dptr = env_img16_pixelsw(result);
+  
+  if (h == 2 || h == 3)
+  {
+    // topmost points  ( [ (6^) 4 ] / 10 )^T
+    for (env_size_t i = 0; i < w; ++i) dptr[i] = (intg16)((src0[i] * 3 + src0[i + w] * 2) / 5);
+  }
+  else
+  {
+    // topmost points  ( [ (8^) 4 ] / 12 )^T
+    for (env_size_t i = 0; i < w; ++i) dptr[i] = (intg16)((src0[i] * 2 + src0[i + w]) / 3);
+    
+    // rest of the column except last 2 points ( [ .^ 4 (8) 4 ] / 16 )T, vectorized when possible, then scalar
+    for (env_size_t j = 1; j < dims2.h; ++j)
+    {
+      const intg16* s1 = src0 + (2*j - 1) * w;
+      const intg16* s2 = s1 + w;
+      const intg16* s3 = s2 + w;
+      intg16* d = dptr + j * w;
+
+      const env_size_t nv = env_simd_lowpass_5_y_dec16(s1 - w, w, d, w);
+      for (env_size_t i = nv; i < w; ++i) d[i] = (intg16)((s1[i] + s3[i] + s2[i] * 2) >> 2);
+    }
+  }
+}
+
+// ######################################################################
+// Generic 9-tap [1 8 28 56 70 56 28 8 1] lowpass with truncated filter, for small images
+static void env_lowpass_9_small16(const intg16* src, const env_size_t n, const env_size_t stride,
+                                  const env_size_t count, const env_size_t step, intg16* dst)
+{
+  const intg32 f_flipped[9] = { 1, 8, 28, 56, 70, 56, 28, 8, 1 };
+  const env_size_t fs2 = 4;
+
+  for (env_size_t c = 0; c < count; ++c)
+  {
+    const intg16* s = src + c * step;
+    intg16* d = dst + c * step;
+
+    for (env_size_t i = 0; i < n; ++i)
+    {
+      intg32 sum = 0, val = 0;
+      for (env_size_t k = 0; k < 9; ++k)
+      {
+        if (i + k < fs2 || i + k >= n + fs2) continue;
+        val += s[((env_ssize_t) i + (env_ssize_t) k - (env_ssize_t) fs2) * (env_ssize_t) stride] * f_flipped[k];
+        sum += f_flipped[k];
+      }
+      d[i * stride] = (intg16)(val / sum);
+    }
+  }
+}
+
+// ######################################################################
+void env_lowpass_9_x16(const struct env_image16* source, struct env_image16* result)
+{
+  ENV_ASSERT(env_dims_equal(result->dims, source->dims));
+  
+  const env_size_t w = source->dims.w;
+  const env_size_t h = source->dims.h;
+  
+  if (w < 2) // nothing to smooth
+  {
+    env_img16_copy_src_dst(source, result);
+    return;
+  }
+
+  const intg16* src = env_img16_pixels(source);
+  intg16* dst = env_img16_pixelsw(result);
+
+  if (w < 9)  // use inefficient implementation for small images
+  {
+    env_lowpass_9_small16(src, w, 1, h, w, dst);
+    return;
+  }
+  
+  for (env_size_t j = 0; j < h; ++j)
+  {
+    const intg16* s = src + j * w;
+    intg16* d = dst + j * w;
+
+    // leftmost points
+    d[0] = (intg16)((s[0] * 72 + s[1] * 56 + s[2] * 28 + s[3] * 8) / 164);
+    d[1] = (intg16)(((s[0] + s[2]) * 56 + s[1] * 72 + s[3] * 28 + s[4] * 8) / 220);
+    d[2] = (intg16)(((s[0] + s[4]) * 28 + (s[1] + s[3]) * 56 + s[2] * 72 + s[5] * 8) / 248);
+
+    // far from the borders, vectorized when possible, then scalar
+    const env_size_t nv = env_simd_lowpass_9_16(s, 1, d + 3, w - 6);
+    for (env_size_t i = 3 + nv; i < w - 3; ++i)
+      d[i] = (intg16)(((s[i-3] + s[i+3]) * 8 + (s[i-2] + s[i+2]) * 28 + (s[i-1] + s[i+1]) * 56 + s[i] * 72) >> 8);
+
+    // rightmost points
+    const intg16* r = s + w - 7;
+    d[w-3] = (intg16)((r[0] * 8 + (r[1] + r[5]) * 28 + (r[2] + r[4]) * 56 + r[3] * 72) / 248);
+    ++r;
+    d[w-2] = (intg16)((r[0] * 8 + r[1] * 28 + (r[2] + r[4]) * 56 + r[3] * 72) / 220);
+    ++r;
+    d[w-1] = (intg16)((r[0] * 8 + r[1] * 28 + r[2] * 56 + r[3] * 72) / 164);
+  }
+}
+
+// ######################################################################
+void env_lowpass_9_y16(const struct env_image16* source, struct env_image16* result)
+{
+  ENV_ASSERT(env_dims_equal(result->dims, source->dims));
+  
+  const env_size_t w = source->dims.w;
+  const env_size_t h = source->dims.h;
+  
+  // if the height is less than 2, then the caller should handle that condition differently since no smoothing need be
+  // done (so the caller could either copy or swap the source into the result location)
+  ENV_ASSERT(h >= 2);
+
+  const intg16* src = env_img16_pixels(source);
+  intg16* dst = env_img16_pixelsw(result);
+  
+  if (h < 9)  // use inefficient implementation for small images
+  {
+    env_lowpass_9_small16(src, h, w, w, 1, dst);
+    return;
+  }
+  
+  // index computation speedup:
+  const env_size_t w2 = w + w, w3 = w2 + w, w4 = w3 + w, w5 = w4 + w, w6 = w5 + w;
+
+  // topmost points:
+  for (env_size_t i = 0; i < w; ++i)
+  {
+    const intg16* s = src + i;
+    dst[i] = (intg16)((s[0] * 72 + s[w] * 56 + s[w2] * 28 + s[w3] * 8) / 164);
+    dst[i + w] = (intg16)(((s[0] + s[w2]) * 56 + s[w] * 72 + s[w3] * 28 + s[w4] * 8) / 220);
+    dst[i + w2] = (intg16)(((s[0] + s[w4]) * 28 + (s[w] + s[w3]) * 56 + s[w2] * 72 + s[w5] * 8) / 248);
+  }
+
+  // far from the borders, vectorized when possible, then scalar:
+  for (env_size_t j = 0; j < h - 6; ++j)
+  {
+    const intg16* s = src + j * w;
+    intg16* d = dst + (j + 3) * w;
+
+    const env_size_t nv = env_simd_lowpass_9_16(s, w, d, w);
+    for (env_size_t i = nv; i < w; ++i)
+      d[i] = (intg16)(((s[i] + s[i + w6]) * 8 + (s[i + w] + s[i + w5]) * 28 + (s[i + w2] + s[i + w4]) * 56 +
+                       s[i + w3] * 72) >> 8);
+  }
+
+  // bottommost points:
+  const intg16* s = src + (h - 7) * w;
+  intg16* d = dst + (h - 3) * w;
+  for (env_size_t i = 0; i < w; ++i)
+  {
+    d[i] = (intg16)((s[i] * 8 + (s[i + w] + s[i + w5]) * 28 + (s[i + w2] + s[i + w4]) * 56 + s[i + w3] * 72) / 248);
+    d[i + w] = (intg16)((s[i + w] * 8 + s[i + w2] * 28 + (s[i + w3] + s[i + w5]) * 56 + s[i + w4] * 72) / 220);
+    d[i + w2] = (intg16)((s[i + w2] * 8 + s[i + w3] * 28 + s[i + w4] * 56 + s[i + w5] * 72) / 164);
+  }
+}
+
+// ######################################################################
+void env_lowpass_9_16(const struct env_image16* src, struct env_image16* result)
+{
+  ENV_ASSERT(env_dims_equal(result->dims, src->dims));
+  
+  struct env_image16 tmp1;
+  env_img16_init(&tmp1, src->dims);
+  env_lowpass_9_x16(src, &tmp1);
+  if (tmp1.dims.h >= 2) env_lowpass_9_y16(&tmp1, result);
+  else env_img16_swap(&tmp1, result);
+  env_img16_make_empty(&tmp1);
+}
+
+// ######################################################################
+void env_quad_energy16(const struct env_image16* img1, const struct env_image16* img2, struct env_image16* result)
+{
+  ENV_ASSERT(env_dims_equal(img1->dims, img2->dims));
+  ENV_ASSERT(env_dims_equal(img1->dims, result->dims));
+  
+  const intg16* s1ptr = env_img16_pixels(img1);
+  const intg16* s2ptr = env_img16_pixels(img2);
+  intg16* dptr = env_img16_pixelsw(result);
+  
+  const env_size_t sz = env_img16_size(img1);
+  const env_size_t nv = env_simd_quad_energy16(s1ptr, s2ptr, dptr, sz);
+  
+  for (env_size_t i = nv; i < sz; ++i)
+  {
+    const intg32 s1 = ENV_ABS((intg32) s1ptr[i]);
+    const intg32 s2 = ENV_ABS((intg32) s2ptr[i]);
+    
+    // Paeth's approximation of sqrt(s1*s1+s2*s2), see env_quad_energy():
+    dptr[i] = env_sat16((s1 > s2) ? (s1 + (s2 >> 1)) : ((s1 >> 1) + s2));
+  }
+}
+
+// ######################################################################
+void env_steerable_filter16(const struct env_image16* src, const intg32 kxnumer, const intg32 kynumer,
+                            const env_size_t kdenombits, const struct env_math* imath, struct env_image16* result)
+{
+  ENV_ASSERT(env_dims_equal(result->dims, src->dims));
+  
+  struct env_image16 re; env_img16_init(&re, src->dims);
+  struct env_image16 im; env_img16_init(&im, src->dims);
+  const intg16* sptr = env_img16_pixels(src);
+  intg16* reptr = env_img16_pixelsw(&re);
+  intg16* imptr = env_img16_pixelsw(&im);
+  
+  // (x,y) = (0,0) at center of image:
+  const env_ssize_t w2l = ((env_ssize_t) src->dims.w) / 2;
+  const env_ssize_t w2r = ((env_ssize_t) src->dims.w) - w2l;
+  const env_ssize_t h2l = ((env_ssize_t) src->dims.h) / 2;
+  const env_ssize_t h2r = ((env_ssize_t) src->dims.h) - h2l;
+  
+  ENV_ASSERT((INTG32_MAX / (ENV_ABS(kxnumer) + ENV_ABS(kynumer))) > (w2r + h2r));
+  
+  // Keep the upshift bits that a 32-bit source would have had. Hipass values of a 12-bit image are within +/-2^12, so
+  // the result still fits in 16 bits:
+  ENV_ASSERT(imath->nbits >= ENV_IMG16_NBITS && imath->nbits - ENV_IMG16_NBITS <= ENV_TRIG_NBITS + 1);
+  const env_size_t shift = ENV_TRIG_NBITS + 1 - (imath->nbits - ENV_IMG16_NBITS);
+
+  for (env_ssize_t j = -h2l; j < h2r; ++j)
+    for (env_ssize_t i = -w2l; i < w2r; ++i)
+    {
+      const intg32 arg = (i * kxnumer + j * kynumer) >> kdenombits;
+      
+      env_ssize_t idx = arg % ENV_TRIG_TABSIZ;
+      if (idx < 0) idx += ENV_TRIG_TABSIZ;
+      
+      const intg32 sval = *sptr++;
+      
+      *reptr++ = env_sat16((sval * imath->costab[idx]) >> shift);
+      *imptr++ = env_sat16((sval * imath->sintab[idx]) >> shift);
+    }
+  
+  env_lowpass_9_16(&re, result);
+  env_img16_swap(&re, result);
+  
+  env_lowpass_9_16(&im, result);
+  env_img16_swap(&im, result);
+  
+  env_quad_energy16(&re, &im, result);
+  
+  env_img16_make_empty(&re);
+  env_img16_make_empty(&im);
+}
+
+// ######################################################################
+void env_attenuate_borders_inplace16(struct env_image16* a, env_size_t size)
+{
+  ENV_ASSERT(env_img16_initialized(a));
+  
+  struct env_dims dims = a->dims;
+  
+  if (size * 2 > dims.w) size = dims.w / 2;
+  if (size * 2 > dims.h) size = dims.h / 2;
+  if (size < 1) return;  // forget it
+  
+  const intg32 size_plus_1 = (intg32) (size+1);
+  
+  // top lines:
+  intg32 coeff = 1;
+  intg16* aptr = env_img16_pixelsw(a);
+  for (env_size_t y = 0; y < size; y ++)
+  {
+    for (env_size_t x = 0; x < dims.w; x ++)
+    {
+      *aptr = (intg16)((*aptr / size_plus_1) * coeff);
+      ++aptr;
+    }
+    ++coeff;
+  }
+  // normal lines: start again from beginning to attenuate corners twice:
+  aptr = env_img16_pixelsw(a);
+  for (env_size_t y = 0; y < dims.h; y ++)
+  {
+    coeff = 1;
+    for (env_size_t x = 0; x < size; x ++)
+    {
+      *(aptr + dims.w - 1 - x * 2) = (intg16)((*(aptr + dims.w - 1 - x * 2) / size_plus_1) * coeff);
+      
+      *aptr = (intg16)((*aptr / size_plus_1) * coeff);
+      ++aptr;
+      ++coeff;
+    }
+    aptr += dims.w - size;
+  }
+  // bottom lines
+  aptr = env_img16_pixelsw(a) + (dims.h - size) * dims.w;
+  coeff = size;
+  for (env_size_t y = dims.h - size; y < dims.h; y ++)
+  {
+    for (env_size_t x = 0; x < dims.w; ++x)
+    {
+      *aptr = (intg16)((*aptr / size_plus_1) * coeff);
+      ++aptr;
+    }
+    --coeff;
+  }
+}
+
+// ######################################################################
+// result = saturate(a - b)
+static void env_image16_minus_image(const struct env_image16* a, const struct env_image16* b,
+                                    struct env_image16* result)
+{
+  ENV_ASSERT(env_dims_equal(a->dims, b->dims));
+  env_img16_resize_dims(result, a->dims);
+
+  const intg16* aptr = env_img16_pixels(a);
+  const intg16* bptr = env_img16_pixels(b);
+  intg16* dptr = env_img16_pixelsw(result);
+  const env_size_t sz = env_img16_size(a);
+
+  const env_size_t nv = env_simd_sub_sat16(aptr, bptr, dptr, sz);
+  for (env_size_t i = nv; i < sz; ++i) dptr[i] = env_sat16(((intg32) aptr[i]) - ((intg32) bptr[i]));
+}
+
+// ######################################################################
+void env_pyr16_build_hipass_9(const struct env_image16* image, env_size_t firstlevel, struct env_pyr16* result)
+{
+  ENV_ASSERT(env_img16_initialized(image));
+  
+  // compute hipass as image - lowpass(image)
+  
+  const env_size_t depth = env_pyr16_depth(result);
+  
+  if (depth == 0) return;
+  
+  struct env_image16 lpfima = env_img16_initializer;
+  
+  env_img16_resize_dims(&lpfima, image->dims);
+  env_lowpass_9_16(image, &lpfima);
+  
+  if (0 == firstlevel) env_image16_minus_image(image, &lpfima, env_pyr16_imgw(result, 0));
+  
+  // now do the rest of the pyramid levels starting from level 1:
+  for (env_size_t lev = 1; lev < depth; ++lev)
+  {
+    struct env_image16 dec = env_img16_initializer;
+    env_dec_xy16(&lpfima, &dec);
+    env_img16_resize_dims(&lpfima, dec.dims);
+    env_lowpass_9_16(&dec, &lpfima);
+    
+    if (lev >= firstlevel) env_image16_minus_image(&dec, &lpfima, env_pyr16_imgw(result, lev));
+    
+    env_img16_make_empty(&dec);
+  }
+  
+  env_img16_make_empty(&lpfima);
+}
+
+// ######################################################################
+void env_pyr16_build_steerable_from_hipass_9(const struct env_pyr16* hipass, const intg32 kxnumer,
+                                             const intg32 kynumer, const env_size_t kdenombits,
+                                             const struct env_math* imath, struct env_pyr16* out)
+{
+  const env_size_t attenuation_width = 5;
+  const env_size_t depth = env_pyr16_depth(hipass);
+  
+  struct env_pyr16 result;
+  env_pyr16_init(&result, depth);
+  
+  for (env_size_t lev = 0; lev < depth; ++lev)
+  {
+    // if the hipass is empty at a given level, then just leave the output empty at that level, too
+    if (!env_img16_initialized(env_pyr16_img(hipass, lev))) continue;
+    
+    env_img16_resize_dims(env_pyr16_imgw(&result, lev), env_pyr16_img(hipass, lev)->dims);
+    
+    env_steerable_filter16(env_pyr16_img(hipass, lev), kxnumer, kynumer, kdenombits, imath,
+                           env_pyr16_imgw(&result, lev));
+
+    // attenuate borders that are overestimated due to filter trunctation:
+    env_attenuate_borders_inplace16(env_pyr16_imgw(&result, lev), attenuation_width);
+  }
+  
+  env_pyr16_swap(out, &result);
+  env_pyr16_make_empty(&result);
+}
+
+// ######################################################################
+void env_pyr16_build_lowpass_5(const struct env_image16* image, env_size_t firstlevel, struct env_pyr16* result)
+{
+  ENV_ASSERT(env_img16_initialized(image));
+  ENV_ASSERT(env_pyr16_depth(result) > 0);
+  
+  if (firstlevel == 0) env_img16_copy_src_dst(image, env_pyr16_imgw(result, 0));
+  
+  const env_size_t depth = env_pyr16_depth(result);
+  
+  for (env_size_t lev = 1; lev < depth; ++lev)
+  {
+    struct env_image16 tmp1 = env_img16_initializer;
+    
+    const struct env_image16* prev = lev == 1 ? image : env_pyr16_img(result, lev-1);
+    
+    env_lowpass_5_x_dec_x16(prev, &tmp1);
+    env_lowpass_5_y_dec_y16(&tmp1, env_pyr16_imgw(result, lev));
+    
+    if ((lev - 1) < firstlevel) env_img16_make_empty(env_pyr16_imgw(result, lev-1));
+    
+    env_img16_make_empty(&tmp1);
+  }
+}
+
+// ######################################################################
+void env_downsize_9_inplace16(struct env_image16* src, const env_size_t depth)
+{
+  for (env_size_t i = 0; i < depth; ++i)
+  {
+    {
+      struct env_image16 tmp1;
+      env_img16_init(&tmp1, src->dims);
+      env_lowpass_9_x16(src, &tmp1);
+      env_dec_x16(&tmp1, src);
+      env_img16_make_empty(&tmp1);
+    }
+    {
+      struct env_image16 tmp2;
+      env_img16_init(&tmp2, src->dims);
+      if (src->dims.h >= 2) env_lowpass_9_y16(src, &tmp2);
+      else env_img16_swap(src, &tmp2);
+      env_dec_y16(&tmp2, src);
+      env_img16_make_empty(&tmp2);
+    }
+  }
+}
+
+// ######################################################################
+void env_rescale16(const struct env_image16* src, struct env_image16* result)
+{
+  const env_ssize_t new_w = (env_ssize_t) result->dims.w;
+  const env_ssize_t new_h = (env_ssize_t) result->dims.h;
+  
+  ENV_ASSERT(env_img16_initialized(src));
+  ENV_ASSERT(new_w > 0 && new_h > 0);
+  
+  const env_ssize_t orig_w = (env_ssize_t) src->dims.w;
+  const env_ssize_t orig_h = (env_ssize_t) src->dims.h;
+  
+  // check if same size already
+  if (new_w == orig_w && new_h == orig_h)
+  {
+    env_img16_copy_src_dst(src, result);
+    return;
+  }
+  
+  intg16* dptr = env_img16_pixelsw(result);
+  const intg16* const sptr = env_img16_pixels(src);
+  
+  // bilinear interpolation, see env_rescale():
+  for (env_ssize_t j = 0; j < new_h; ++j)
+  {
+    const env_ssize_t y_numer = ENV_MAX(((env_ssize_t) 0), j*2*orig_h+orig_h-new_h);
+    const env_ssize_t y_denom = 2*new_h;
+    
+    const env_ssize_t y0 = y_numer / y_denom;
+    const env_ssize_t y1 = ENV_MIN(y0 + 1, orig_h - 1);
+    
+    const env_ssize_t fy_numer = y_numer - y0 * y_denom;
+    const env_ssize_t fy_denom = y_denom;
+    
+    const env_ssize_t wy0 = orig_w * y0;
+    const env_ssize_t wy1 = orig_w * y1;
+    
+    for (env_ssize_t i = 0; i < new_w; ++i)
+    {
+      const env_ssize_t x_numer = ENV_MAX(((env_ssize_t) 0), i*2*orig_w+orig_w-new_w);
+      const env_ssize_t x_denom = 2*new_w;
+      
+      const env_ssize_t x0 = x_numer / x_denom;
+      const env_ssize_t x1 = ENV_MIN(x0 + 1, orig_w - 1);
+      
+      const env_ssize_t fx_numer = x_numer - x0 * x_denom;
+      const env_ssize_t fx_denom = x_denom;
+      
+      const intg32 d00 = sptr[x0 + wy0];
+      const intg32 d10 = sptr[x1 + wy0];
+      
+      const intg32 d01 = sptr[x0 + wy1];
+      const intg32 d11 = sptr[x1 + wy1];
+      
+      const intg32 dx0 = d00 + ((d10 - d00) / fx_denom) * fx_numer;
+      const intg32 dx1 = d01 + ((d11 - d01) / fx_denom) * fx_numer;
+      
+      *dptr++ = (intg16)(dx0 + ((dx1 - dx0) / fy_denom) * fy_numer);
+    }
+  }
+}
+
+// ######################################################################
+// Normalize from [mi..ma] to [nmin..nmax]
+static void env_img16_inplace_normalize(intg16* const dst, const env_size_t sz, const intg32 mi, const intg32 ma,
+                                        const intg32 nmin, const intg32 nmax, intg32* const actualmin_p,
+                                        intg32* const actualmax_p, const intg32 rangeThresh)
+{
+  ENV_ASSERT(sz > 0);
+  ENV_ASSERT(nmax >= nmin);
+
+  const intg32 old_scale = ma - mi;
+  if (old_scale == 0 || old_scale < rangeThresh) // input image is uniform
+  { for (env_size_t i = 0; i < sz; ++i) dst[i] = 0; return; }
+  const intg32 new_scale = nmax - nmin;
+  
+  if (new_scale == 0) // output range is uniform
+  { for (env_size_t i = 0; i < sz; ++i) dst[i] = (intg16)nmin; return; }
+
+  // Multiply by a 16.16 fixed-point reciprocal instead of dividing each pixel. It is rounded up so that ma maps exactly
+  // to nmax, other values may come out 1 above the exact division. With 16-bit values, (val - mi) * factor is at most
+  // new_scale * 2^16 + old_scale - 1, which fits in 32 bits:
+  const intg32 factor = ((new_scale << 16) + old_scale - 1) / old_scale;
+
+  // vectorized when possible, then scalar:
+  const env_size_t nv = env_simd_normalize16(dst, sz, (intg16) mi, (intg16) nmin, factor);
+  for (env_size_t i = nv; i < sz; ++i) dst[i] = (intg16)(nmin + (((dst[i] - mi) * factor) >> 16));
+
+  if (actualmin_p) *actualmin_p = nmin;
+  if (actualmax_p) *actualmax_p = nmax;
+}
+
+// ######################################################################
+intg32 env_max_normalize16_inplace(struct env_image16* src, const intg16 nmi, const intg16 nma,
+                                   const enum env_maxnorm_type normtyp, const intg32 rangeThresh,
+                                   const env_size_t upshift)
+{
+  if (!env_img16_initialized(src)) return 1;
+
+  ENV_ASSERT2(normtyp == ENV_VCXNORM_NONE || normtyp == ENV_VCXNORM_MAXNORM, "Invalid normalization type");
+
+  // first clamp negative values to zero, getting the min and max of the clamped image along the way, vectorized when
+  // possible, then scalar:
+  intg16* const dptr = env_img16_pixelsw(src);
+  const env_size_t sz = env_img16_size(src);
+  intg16 vmi = INTG16_MAX, vma = 0;
+  const env_size_t nv = env_simd_clamp_minmax16(dptr, sz, &vmi, &vma);
+  intg32 imi = vmi, ima = vma;
+  for (env_size_t i = nv; i < sz; ++i)
+  {
+    if (dptr[i] < 0) dptr[i] = 0;
+    if (dptr[i] < imi) imi = dptr[i];
+    if (dptr[i] > ima) ima = dptr[i];
+  }
+  
+  // then, normalize between mi and ma if not zero
+  intg32 mi = nmi;
+  intg32 ma = nma;
+  if (nmi != 0 || nma != 0) env_img16_inplace_normalize(dptr, sz, imi, ima, nmi, nma, &mi, &ma, rangeThresh);
+
+  if (normtyp == ENV_VCXNORM_NONE) return 1;
+
+  const env_size_t w = src->dims.w;
+  const env_size_t h = src->dims.h;
+  
+  // we want to detect quickly local maxes, but avoid getting local mins
+  const intg32 thresh = mi + (ma - mi) / 10;
+  
+  // then get the mean value of the local maxima, vectorized when possible, then scalar:
+  intg32 lm_mean = 0;
+  env_size_t numlm = 0;
+  const env_size_t n = w > 2 ? w - 2 : 0;
+  for (env_size_t j = 1; j+1 < h; ++j)
+  {
+    const env_size_t nvj = env_simd_local_max16(dptr + w * j + 1, w, (intg16) thresh, n, &numlm, &lm_mean);
+    for (env_size_t i = 1 + nvj; i+1 < w; ++i)
+    {
+      const env_size_t index = i + w * j;
+      const intg32 val = dptr[index];
+      if (val >= thresh &&
+          val >= dptr[index - w] &&
+          val >= dptr[index + w] &&
+          val >= dptr[index - 1] &&
+          val >= dptr[index + 1])  // local max
+      {
+        ++numlm;
+        lm_mean += val;
+      }
+    }
+  }
+  
+  if (numlm > 0) lm_mean /= numlm;
+  
+  ENV_ASSERT(ma >= lm_mean);
+
+  // The factor is computed at the scale of the 32-bit images, which only differ from ours by a left shift:
+  ma <<= upshift; lm_mean <<= upshift;
+  
+  // scale factor is (max - mean_local_max)^2:
+  if (numlm > 1) return ((ma - lm_mean) * (ma - lm_mean)) / ma;
+  else if (numlm == 1) return ma; // a single narrow peak
+  return 1;
+}
+
+// ######################################################################
+void env_center_surround16(const struct env_image16* center, const struct env_image16* surround,
+                           const int absol, struct env_image16* result)
+{
+  env_center_surround_rows16(center, surround, absol, result, 0, center->dims.h);
+  
+  // attenuate borders:
+  env_attenuate_borders_inplace16(result, ENV_MAX(result->dims.w, result->dims.h) / 20);
+}
+
+// ######################################################################
+void env_center_surround_rows16(const struct env_image16* center, const struct env_image16* surround,
+                                const int absol, struct env_image16* result, const env_size_t y0,
+                                const env_size_t y1)
+{
+  // result has the size of the larger image:
+  ENV_ASSERT(env_dims_equal(result->dims, center->dims));
+  ENV_ASSERT(y0 <= y1 && y1 <= center->dims.h);
+  
+  const env_size_t lw = center->dims.w, lh = center->dims.h;
+  const env_size_t sw = surround->dims.w, sh = surround->dims.h;
+  
+  ENV_ASSERT2(lw >= sw && lh >= sh, "center must be larger than surround");
+  
+  const env_size_t scalex = lw / sw, scaley = lh / sh;
+  
+  // Center pixel (i, j) is compared to surround pixel (i / scalex, j / scaley), except that the non-round columns and
+  // rows at the right and bottom all map to the last surround column and row. Each surround row is expanded to the
+  // center width once, so that the differences can then be vectorized:
+  intg16* const srow = (intg16*) env_allocate(lw * sizeof(intg16));
+  env_size_t sj_expanded = sh;
+  
+  for (env_size_t j = y0; j < y1; ++j)
+  {
+    const env_size_t sj = ENV_MIN(j / scaley, sh - 1);
+    if (sj != sj_expanded)
+    {
+      const intg16* sptr = env_img16_pixels(surround) + sj * sw;
+      env_size_t i = 0;
+      for (env_size_t si = 0; si < sw; ++si) for (env_size_t c = 0; c < scalex; ++c) srow[i++] = sptr[si];
+      while (i < lw) srow[i++] = sptr[sw - 1];
+      sj_expanded = sj;
+    }
+    
+    const intg16* lptr = env_img16_pixels(center) + j * lw;
+    intg16* dptr = env_img16_pixelsw(result) + j * lw;
+    
+    // abs(hires - lowres), or hires - lowres clamped to 0, vectorized when possible, then scalar:
+    const env_size_t nv = env_simd_center_surround16(lptr, srow, absol, dptr, lw);
+    for (env_size_t i = nv; i < lw; ++i)
+    {
+      const intg32 l = lptr[i], s = srow[i];
+      if (l > s) dptr[i] = env_sat16(l - s);
+      else dptr[i] = absol ? env_sat16(s - l) : 0;
+    }
+  }
+  
+  env_deallocate(srow);
+}
@@ -0,0 +1,119 @@
+/*!@file Envision/env_image16_ops.h Fixed-point integer math operations on 16-bit images */
+
+// //////////////////////////////////////////////////////////////////// //
+// The iLab Neuromorphic Vision C++ Toolkit - Copyright (C) 2001 by the //
+// University of Southern California (USC) and the iLab at USC.         //
+// See http://iLab.usc.edu for information about this project.          //
+// //////////////////////////////////////////////////////////////////// //
+// Major portions of the iLab Neuromorphic Vision Toolkit are protected //
+// under the U.S. patent ``Computation of Intrinsic Perceptual Saliency //
+// in Visual Environments, and Applications'' by Christof Koch and      //
+// Laurent Itti, California Institute of Technology, 2001 (patent       //
+// pending; application number 09/912,225 filed July 23, 2001; see      //
+// http://pair.uspto.gov/cgi-bin/final/home.pl for current status).     //
+// //////////////////////////////////////////////////////////////////// //
+// This file is part of the iLab Neuromorphic Vision C++ Toolkit.       //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is free software; you can   //
+// redistribute it and/or modify it under the terms of the GNU General  //
+// Public License as published by the Free Software Foundation; either  //
+// version 2 of the License, or (at your option) any later version.     //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is distributed in the hope  //
+// that it will be useful, but WITHOUT ANY WARRANTY; without even the   //
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR      //
+// PURPOSE.  See the GNU General Public License for more details.       //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with the iLab Neuromorphic Vision C++ Toolkit; if not, write   //
+// to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,   //
+// Boston, MA 02111-1307 USA.                                           //
+// //////////////////////////////////////////////////////////////////// //
+//
+
+#pragma once
+
+#include <jevoisbase/src/Components/Saliency/env_config.h>
+#include <jevoisbase/src/Components/Saliency/env_image16.h>
+#include <jevoisbase/src/Components/Saliency/env_math.h>
+
+//! Max value to which 16-bit maps are normalized, the 32-bit equivalent being INTMAXNORMMAX
+#define INTMAXNORMMAX16 ((intg16) 16384)
+
+//! Left shift that brings INTMAXNORMMAX16 to INTMAXNORMMAX
+#define INTMAXNORMMAX_UPSHIFT16 ((env_size_t) 1)
+
+// These mirror the functions of env_image_ops.h, operating on intg16 pixels. Filter sums are computed in 32 bits and
+// results that may exceed the input range (differences) are saturated when stored back to 16 bits. The inner loops of
+// the filters, differences and normalization use the 16-bit kernels of env_simd_ops.h when the CPU supports them.
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+  
+  //! Decimate in X and Y (take one every 'factor' pixels).
+  void env_dec_xy16(const struct env_image16* src, struct env_image16* result);
+  
+  //! Decimate in X (take one every 'factor' pixels).
+  void env_dec_x16(const struct env_image16* src, struct env_image16* result);
+  
+  //! Decimate in Y (take one every 'factor' pixels).
+  void env_dec_y16(const struct env_image16* src, struct env_image16* result);
+  
+  void env_lowpass_5_x_dec_x16(const struct env_image16* src, struct env_image16* result);
+  
+  void env_lowpass_5_y_dec_y16(const struct env_image16* src, struct env_image16* result);
+  
+  void env_lowpass_9_x16(const struct env_image16* src, struct env_image16* result);
+
+  void env_lowpass_9_y16(const struct env_image16* src, struct env_image16* result);
+
+  void env_lowpass_9_16(const struct env_image16* src, struct env_image16* result);
+
+  void env_quad_energy16(const struct env_image16* img1, const struct env_image16* img2,
+                         struct env_image16* result);
+
+  //! Steerable filter of a 16-bit hipass image
+  /*! Hipass images have little energy, so the result is not scaled down to 16-bit pixel scale: it is on the same scale
+      as what env_steerable_filter() computes from the corresponding 32-bit image. Pyramids built from it should be
+      processed with a pyrshift of zero in env_chan_process_pyr16(). */
+  void env_steerable_filter16(const struct env_image16* src, const intg32 kxnumer, const intg32 kynumer,
+                              const env_size_t kdenombits, const struct env_math* imath,
+                              struct env_image16* result);
+
+  void env_attenuate_borders_inplace16(struct env_image16* a, env_size_t size);
+  
+  void env_pyr16_build_hipass_9(const struct env_image16* image, env_size_t firstlevel, struct env_pyr16* result);
+  
+  void env_pyr16_build_steerable_from_hipass_9(const struct env_pyr16* hipass, const intg32 kxnumer,
+                                               const intg32 kynumer, const env_size_t kdenombits,
+                                               const struct env_math* imath, struct env_pyr16* result);
+
+  void env_pyr16_build_lowpass_5(const struct env_image16* image, env_size_t firstlevel, struct env_pyr16* result);
+  
+  void env_downsize_9_inplace16(struct env_image16* src, const env_size_t depth);
+
+  void env_rescale16(const struct env_image16* src, struct env_image16* result);
+
+  //! Rectify, normalize to [min..max] and, for ENV_VCXNORM_MAXNORM, compute the max-normalization factor
+  /*! Unlike env_max_normalize_inplace(), the factor is not applied to the image, as the result would not fit in 16
+      bits. Instead it is returned, so that it can be applied when the image is accumulated into a 32-bit map. The
+      factor is computed for values scaled up by 2^upshift, i.e., the 32-bit image equivalent to the normalized one is
+      (src << upshift) * factor. Returns 1 if no factor should be applied. The normalization multiplies by a
+      fixed-point reciprocal of the input range, so a pixel may come out 1 above what an exact division would give. */
+  intg32 env_max_normalize16_inplace(struct env_image16* src, intg16 min, intg16 max, enum env_maxnorm_type typ,
+                                     const intg32 rangeThresh, const env_size_t upshift);
+  
+  void env_center_surround16(const struct env_image16* center, const struct env_image16* surround,
+                             const int absol, struct env_image16* result);
+
+  //! Compute rows [y0..y1) of env_center_surround16(), without the border attenuation
+  /*! Different row ranges of the same result can be computed concurrently. */
+  void env_center_surround_rows16(const struct env_image16* center, const struct env_image16* surround,
+                                  const int absol, struct env_image16* result, const env_size_t y0,
+                                  const env_size_t y1);
+
+#ifdef __cplusplus
+}
+#endif
@@ -37,8 +37,10 @@
 
 #include <jevoisbase/src/Components/Saliency/env_image_ops.h>
 
+#include <jevoisbase/src/Components/Saliency/env_alloc.h>
 #include <jevoisbase/src/Components/Saliency/env_c_math_ops.h>
 #include <jevoisbase/src/Components/Saliency/env_log.h>
+#include <jevoisbase/src/Components/Saliency/env_simd_ops.h>
 
 
 // ######################################################################
@@ -400,6 +402,216 @@ void env_steerable_filter(const struct env_image* src, const intg32 kxnumer, con
   env_img_make_empty(&im);
 }
 
+//! Approximate size of the working buffers of env_steerable_filter_bank(), which processes row strips that fit in them
+#define ENV_BANK_STRIP_BYTES 262144
+
+// ######################################################################
+//! 9-tap lowpass of nl interleaved values at position p of a line of length len, with values spaced by stride
+/*! Samples are read around pix, which points to the values at position p. When len >= 9 this is only used within 3
+    samples of the line ends, and gives the same results as the truncated filter of env_c_lowpass_9_x_fewbits_optim()
+    and env_c_lowpass_9_y_fewbits_optim() there. Otherwise, it gives the same results as the full 9-tap filter that
+    env_lowpass_9_x() and env_lowpass_9_y() use for small images. */
+static void bank_lowpass_9_at(const intg32* pix, const env_size_t stride, const env_size_t len, const env_size_t p,
+                              const env_size_t nl, intg32* dst)
+{
+  static const intg32 taps7[7] = { 8, 28, 56, 72, 56, 28, 8 };
+  static const intg32 taps9[9] = { 1, 8, 28, 56, 70, 56, 28, 8, 1 };
+  const intg32* taps = (len >= 9) ? taps7 : taps9;
+  const env_ssize_t half = (len >= 9) ? 3 : 4;
+  
+  const env_ssize_t d0 = ENV_MAX(-half, -((env_ssize_t) p));
+  const env_ssize_t d1 = ENV_MIN(half, ((env_ssize_t) len) - 1 - ((env_ssize_t) p));
+  
+  intg32 sum = 0;
+  for (env_ssize_t d = d0; d <= d1; ++d) sum += taps[d + half];
+  
+  for (env_size_t k = 0; k < nl; ++k)
+  {
+    intg32 val = 0;
+    for (env_ssize_t d = d0; d <= d1; ++d)
+      val += pix[d * ((env_ssize_t) stride) + k] * taps[d + half];
+    dst[k] = val / sum;
+  }
+}
+
+// ######################################################################
+//! Interior of the 9-tap lowpass over n consecutive outputs, see env_simd_lowpass_9()
+static void bank_lowpass_9_run(const intg32* src, const env_size_t stride, intg32* dst, const env_size_t n)
+{
+  const env_size_t s2 = stride + stride, s3 = s2 + stride, s4 = s3 + stride, s5 = s4 + stride, s6 = s5 + stride;
+  
+  for (env_size_t k = env_simd_lowpass_9(src, stride, dst, n); k < n; ++k)
+    dst[k] =
+      ((src[k] + src[k + s6]) *  8 +
+       (src[k + stride] + src[k + s5]) * 28 +
+       (src[k + s2] + src[k + s4]) * 56 +
+       src[k + s3] * 72
+       ) >> 8;
+}
+
+// ######################################################################
+void env_steerable_filter_bank(const struct env_image* src, const env_size_t n, const intg32* kxnumer,
+                               const intg32* kynumer, const env_size_t kdenombits, const struct env_math* imath,
+                               const env_size_t r0, const env_size_t r1, struct env_image* results)
+{
+  const env_size_t w = src->dims.w, h = src->dims.h;
+  
+  ENV_ASSERT(n > 0);
+  ENV_ASSERT(r0 <= r1 && r1 <= h);
+  for (env_size_t o = 0; o < n; ++o) ENV_ASSERT(env_dims_equal(results[o].dims, src->dims));
+  
+  if (r0 == r1) return;
+  
+  // Our 2*n planes (real and imaginary parts of each orientation) are interleaved by rows: each row of our buffers
+  // holds row j of all the planes, one after the other. We work on strips of output rows small enough for the
+  // x-filtered rows they need (4 more on each side) to stay in cache:
+  const env_size_t nl = 2 * n, wl = w * nl;
+  const env_size_t strip = ENV_MIN(ENV_MAX(ENV_BANK_STRIP_BYTES / (wl * sizeof(intg32)), 16) - 8, r1 - r0);
+  
+  intg32* const mrow = (intg32*) env_allocate(wl * sizeof(intg32));
+  intg32* const xlp = (intg32*) env_allocate((strip + 8) * wl * sizeof(intg32));
+  intg32* const ylp = (intg32*) env_allocate(strip * wl * sizeof(intg32));
+  
+  // (x,y) = (0,0) at center of image:
+  const env_ssize_t w2l = ((env_ssize_t) w) / 2;
+  const env_ssize_t w2r = ((env_ssize_t) w) - w2l;
+  const env_ssize_t h2l = ((env_ssize_t) h) / 2;
+  const env_ssize_t h2r = ((env_ssize_t) h) - h2l;
+  
+  ENV_ASSERT((2 * ENV_TRIG_NBITS + 1) < 8*sizeof(intg32));
+  
+  // The modulation phase (x * kx + y * ky) is split into a column phase and a row phase, so that the modulation becomes
+  // a complex product of a column phasor, tabulated once, and a row phasor: the real part is modulated by cx*cy - sx*sy
+  // (cosine of the sum of the phases) and the imaginary part by sx*cy + cx*sy (sine of the sum):
+  intg32* const cx = (intg32*) env_allocate(2 * n * w * sizeof(intg32));
+  intg32* const sx = cx + n * w;
+  
+  for (env_size_t o = 0; o < n; ++o)
+  {
+    // let's do a conservative check to make sure that we won't overflow when we compute the phases, see
+    // env_steerable_filter():
+    ENV_ASSERT((INTG32_MAX / (ENV_ABS(kxnumer[o]) + ENV_ABS(kynumer[o]) + 1)) > (w2r + h2r));
+    
+    for (env_ssize_t i = -w2l; i < w2r; ++i)
+    {
+      // Round the column phase to nearest, as the row phase is truncated below:
+      env_ssize_t idx = (i * kxnumer[o] + (1 << (kdenombits - 1))) >> kdenombits;
+      idx %= (env_ssize_t) ENV_TRIG_TABSIZ; if (idx < 0) idx += ENV_TRIG_TABSIZ;
+      
+      cx[o * w + i + w2l] = imath->costab[idx];
+      sx[o * w + i + w2l] = imath->sintab[idx];
+    }
+  }
+  
+#ifndef ENV_NO_DEBUG
+  const intg32 mdcutoff = INTG32_MAX >> (ENV_TRIG_NBITS+1);
+#endif
+  
+  // Rows [base, next) of the x-filtered planes are in xlp:
+  env_size_t base = (r0 >= 4) ? r0 - 4 : 0, next = base;
+  
+  for (env_size_t j0 = r0; j0 < r1; j0 += strip)
+  {
+    const env_size_t j1 = ENV_MIN(j0 + strip, r1);
+    
+    // Modulate and lowpass in x the rows we need and do not have yet:
+    for (; next < ENV_MIN(j1 + 4, h); ++next)
+    {
+      const intg32* sptr = env_img_pixels(src) + next * w;
+      
+#ifndef ENV_NO_DEBUG
+      for (env_size_t i = 0; i < w; ++i) ENV_ASSERT(ENV_ABS(sptr[i]) < mdcutoff);
+#endif
+      
+      for (env_size_t o = 0; o < n; ++o)
+      {
+        env_ssize_t idx = ((((env_ssize_t) next) - h2l) * kynumer[o]) >> kdenombits;
+        idx %= (env_ssize_t) ENV_TRIG_TABSIZ; if (idx < 0) idx += ENV_TRIG_TABSIZ;
+        const intg32 cy = imath->costab[idx], sy = imath->sintab[idx];
+        
+        const intg32* xc = cx + o * w;
+        const intg32* xs = sx + o * w;
+        intg32* re = mrow + 2 * o * w;
+        intg32* im = re + w;
+        
+        for (env_size_t i = env_simd_steerable_modulate(sptr, xc, xs, cy, -sy, re, w); i < w; ++i)
+          re[i] = (sptr[i] * ((xc[i] * cy - xs[i] * sy + (1 << (ENV_TRIG_NBITS-1))) >> ENV_TRIG_NBITS))
+            >> (ENV_TRIG_NBITS+1);
+        
+        for (env_size_t i = env_simd_steerable_modulate(sptr, xs, xc, cy, sy, im, w); i < w; ++i)
+          im[i] = (sptr[i] * ((xs[i] * cy + xc[i] * sy + (1 << (ENV_TRIG_NBITS-1))) >> ENV_TRIG_NBITS))
+            >> (ENV_TRIG_NBITS+1);
+      }
+      
+      for (env_size_t k = 0; k < nl; ++k)
+      {
+        const intg32* mptr = mrow + k * w;
+        intg32* const xptr = xlp + (next - base) * wl + k * w;
+        if (w >= 9)
+        {
+          for (env_size_t i = 0; i < 3; ++i)
+          {
+            bank_lowpass_9_at(mptr + i, 1, w, i, 1, xptr + i);
+            bank_lowpass_9_at(mptr + w - 1 - i, 1, w, w - 1 - i, 1, xptr + w - 1 - i);
+          }
+          bank_lowpass_9_run(mptr, 1, xptr + 3, w - 6);
+        }
+        else
+          for (env_size_t i = 0; i < w; ++i) bank_lowpass_9_at(mptr + i, 1, w, i, 1, xptr + i);
+      }
+    }
+    
+    // Lowpass in y the rows of our strip, for all planes at once. Single-row images are not smoothed in y, as in
+    // env_lowpass_9():
+    const intg32* yptr = ylp;
+    if (h >= 2)
+    {
+      env_size_t j = j0;
+      while (j < j1)
+        if (h >= 9 && j >= 3 && j + 3 < h)
+        {
+          // Do all our interior rows at once:
+          const env_size_t je = ENV_MIN(j1, h - 3);
+          bank_lowpass_9_run(xlp + (j - 3 - base) * wl, wl, ylp + (j - j0) * wl, (je - j) * wl);
+          j = je;
+        }
+        else
+        {
+          bank_lowpass_9_at(xlp + (j - base) * wl, wl, h, j, wl, ylp + (j - j0) * wl);
+          ++j;
+        }
+    }
+    else yptr = xlp + (j0 - base) * wl;
+    
+    // Quadrature energy of each orientation, see env_quad_energy():
+    for (env_size_t j = j0; j < j1; ++j)
+      for (env_size_t o = 0; o < n; ++o)
+      {
+        const intg32* re = yptr + (j - j0) * wl + 2 * o * w;
+        const intg32* im = re + w;
+        intg32* dptr = env_img_pixelsw(&results[o]) + j * w;
+        
+        for (env_size_t i = 0; i < w; ++i)
+        {
+          const intg32 s1 = ENV_ABS(re[i]);
+          const intg32 s2 = ENV_ABS(im[i]);
+          dptr[i] = ENV_MAX(s1, s2) + (ENV_MIN(s1, s2) >> 1);
+        }
+      }
+    
+    // Slide the x-filtered rows that the next strip still needs to the top of our buffer:
+    const env_size_t keep = ENV_MAX(base, (j1 >= 4) ? j1 - 4 : 0);
+    if (j1 < r1)
+      for (env_size_t k = 0; k < (next - keep) * wl; ++k) xlp[k] = xlp[(keep - base) * wl + k];
+    base = keep;
+  }
+  
+  env_deallocate(cx);
+  env_deallocate(ylp);
+  env_deallocate(xlp);
+  env_deallocate(mrow);
+}
+
 // ######################################################################
 void env_attenuate_borders_inplace(struct env_image* a, env_size_t size)
 {
@@ -557,6 +769,25 @@ void env_pyr_build_lowpass_5(const struct env_image* image, env_size_t firstleve
   }
 }
 
+// ######################################################################
+void env_pyr_build_lowpass_5_above(struct env_pyr* pyr, const env_size_t lev, const struct env_math* imath)
+{
+  ENV_ASSERT(lev < env_pyr_depth(pyr));
+  ENV_ASSERT(env_img_initialized(env_pyr_img(pyr, lev)));
+  
+  const env_size_t depth = env_pyr_depth(pyr);
+  
+  for (env_size_t l = lev + 1; l < depth; ++l)
+  {
+    struct env_image tmp1 = env_img_initializer;
+    
+    env_lowpass_5_x_dec_x(env_pyr_img(pyr, l-1), imath, &tmp1);
+    env_lowpass_5_y_dec_y(&tmp1, imath, env_pyr_imgw(pyr, l));
+    
+    env_img_make_empty(&tmp1);
+  }
+}
+
 // ######################################################################
 void env_downsize_9_inplace(struct env_image* src, const env_size_t depth,
                             const struct env_math* imath)
@@ -762,9 +993,21 @@ void env_max_normalize_std_inplace(struct env_image* src,
 // ######################################################################
 void env_center_surround(const struct env_image* center, const struct env_image* surround,
                          const int absol, struct env_image* result)
+{
+  env_center_surround_rows(center, surround, absol, result, 0, center->dims.h);
+  
+  // attenuate borders:
+  env_attenuate_borders_inplace(result, ENV_MAX(result->dims.w, result->dims.h) / 20);
+}
+
+// ######################################################################
+void env_center_surround_rows(const struct env_image* center, const struct env_image* surround,
+                              const int absol, struct env_image* result, const env_size_t y0,
+                              const env_size_t y1)
 {
   // result has the size of the larger image:
   ENV_ASSERT(env_dims_equal(result->dims, center->dims));
+  ENV_ASSERT(y0 <= y1 && y1 <= center->dims.h);
   
   const env_size_t lw = center->dims.w, lh = center->dims.h;
   const env_size_t sw = surround->dims.w, sh = surround->dims.h;
@@ -774,15 +1017,18 @@ void env_center_surround(const struct env_image* center, const struct env_image*
   const env_size_t scalex = lw / sw, remx = lw - 1 - (lw % sw);
   const env_size_t scaley = lh / sh, remy = lh - 1 - (lh % sh);
   
-  // scan large image and subtract corresponding pixel from small image:
-  env_size_t ci = 0, cj = 0;
-  const intg32* lptr = env_img_pixels(center);
+  // scan large image and subtract corresponding pixel from small image, starting at row y0, which maps to surround
+  // row y0 / scaley except for the non-round rows after remy, which all map to the last surround row:
+  env_size_t ci = 0, cj;
+  const intg32* lptr = env_img_pixels(center) + y0 * lw;
   const intg32* sptr = env_img_pixels(surround);
-  intg32* dptr = env_img_pixelsw(result);
+  intg32* dptr = env_img_pixelsw(result) + y0 * lw;
+  if (y0 <= remy) { cj = y0 % scaley; sptr += (y0 / scaley) * sw; }
+  else { cj = scaley; sptr += (sh - 1) * sw; }
   
   if (absol)  // compute abs(hires - lowres):
   {
-    for (env_size_t j = 0; j < lh; ++j)
+    for (env_size_t j = y0; j < y1; ++j)
     {
       for (env_size_t i = 0; i < lw; ++i)
       {
@@ -797,7 +1043,7 @@ void env_center_surround(const struct env_image* center, const struct env_image*
   }
   else  // compute hires - lowres, clamped to 0:
   {
-    for (env_size_t j = 0; j < lh; ++j)
+    for (env_size_t j = y0; j < y1; ++j)
     {
       for (env_size_t i = 0; i < lw; ++i)
       {
@@ -810,9 +1056,6 @@ void env_center_surround(const struct env_image* center, const struct env_image*
       if ((++cj) == scaley && j != remy) cj = 0; else sptr -= sw;
     }
   }
-  
-  // attenuate borders:
-  env_attenuate_borders_inplace(result, ENV_MAX(result->dims.w, result->dims.h) / 20);
 }
 
 // ######################################################################
@@ -1093,3 +1336,48 @@ void env_shift_image(const struct env_image* srcImg, const env_ssize_t dxnumer,
   }
 }
 
+// ######################################################################
+void env_shift_taps_init(const struct env_dims dims, const env_ssize_t dxnumer, const env_ssize_t dynumer,
+                         const env_size_t denombits, struct env_shift_taps* taps)
+{
+  ENV_ASSERT(denombits < 8*sizeof(intg32));
+  
+  const env_ssize_t denom = (1 << denombits);
+  const env_ssize_t w = (env_ssize_t) dims.w;
+  const env_ssize_t h = (env_ssize_t) dims.h;
+  
+  // Same integer and fractional parts of the shift as in env_shift_image():
+  env_ssize_t xt = dxnumer >= 0 ? (dxnumer >> denombits) : - ((-dxnumer + denom-1) >> denombits);
+  env_ssize_t xfrac_numer = dxnumer - xt * denom;
+  env_ssize_t yt = dynumer >= 0 ? (dynumer >> denombits) : - ((-dynumer + denom-1) >> denombits);
+  env_ssize_t yfrac_numer = dynumer - yt * denom;
+  
+  taps->denombits = denombits;
+  taps->x0 = taps->x1 = taps->y0 = taps->y1 = 0;
+  
+  if (xfrac_numer == 0 && yfrac_numer == 0)
+  {
+    // Same as env_shift_clean(): result(x, y) = src(x - xt, y - yt) when that is inside the image, otherwise 0:
+    taps->xt = xt; taps->yt = yt; taps->xfrac = 0; taps->yfrac = 0;
+    if (ENV_ABS(xt) >= w || ENV_ABS(yt) >= h) return;
+    
+    taps->x0 = ENV_MAX(((env_ssize_t) 0), xt); taps->x1 = ENV_MIN(w, w + xt);
+    taps->y0 = ENV_MAX(((env_ssize_t) 0), yt); taps->y1 = ENV_MIN(h, h + yt);
+    return;
+  }
+  
+  // Fractional shift: env_shift_image() computes nx * ny output pixels, starting at (max(xt, 0), max(yt, 0)) once xt
+  // and yt are rounded up, from a 2x2 source neighborhood at (x - xt, y - yt):
+  const env_ssize_t nx = (ENV_MIN(((env_ssize_t) 0),xt) + w - 1) - ENV_MAX(((env_ssize_t) 0),xt);
+  const env_ssize_t ny = (ENV_MIN(((env_ssize_t) 0),yt) + h - 1) - ENV_MAX(((env_ssize_t) 0),yt);
+  
+  if (xfrac_numer > 0) { xfrac_numer = denom - xfrac_numer; ++xt; }
+  if (yfrac_numer > 0) { yfrac_numer = denom - yfrac_numer; ++yt; }
+  
+  taps->xt = xt; taps->yt = yt; taps->xfrac = xfrac_numer; taps->yfrac = yfrac_numer;
+  if (nx <= 0 || ny <= 0) return;
+  
+  taps->x0 = ENV_MAX(((env_ssize_t) 0), xt); taps->x1 = taps->x0 + nx;
+  taps->y0 = ENV_MAX(((env_ssize_t) 0), yt); taps->y1 = taps->y0 + ny;
+}
+
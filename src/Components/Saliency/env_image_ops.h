@@ -44,6 +44,19 @@
 
 struct env_rgb_pixel;
 
+//! Source taps of a shift by (dxnumer, dynumer) / 2^denombits, as applied by env_shift_image()
+/*! The shifted image is zero outside [x0, x1) x [y0, y1). Inside, pixel (x, y) is read from the source pixel
+    (x - xt, y - yt), directly for integer shifts (xfrac and yfrac both zero), otherwise by bilinear interpolation of
+    the 2x2 source neighborhood that starts there. This allows a shifted image to be used without storing it. */
+struct env_shift_taps
+{
+    env_ssize_t xt, yt;       // source offset
+    intg32 xfrac, yfrac;      // interpolation weights of the right and bottom taps, out of 2^denombits
+    env_size_t denombits;     // precision of the weights
+    env_ssize_t x0, x1;       // valid range of shifted columns
+    env_ssize_t y0, y1;       // valid range of shifted rows
+};
+
 #define INTMAXNORMMIN ((intg32) 0)
 #define INTMAXNORMMAX ((intg32) 32768)
 
@@ -87,6 +100,22 @@ extern "C"
                             const struct env_math* imath,
                             struct env_image* result);
   void env_attenuate_borders_inplace(struct env_image* a, env_size_t size);
+
+  //! Steerable filters of n orientations at once, computing output rows [r0, r1) of each of the n results
+  /*! Each results[o] must have the dims of src, and gets approximately what env_steerable_filter() would give with
+      kxnumer[o] and kynumer[o]. The source is read once for all orientations, the modulation phase is split into a
+      column phase and a row phase so that modulating becomes a vectorized product with tabulated phasors, and the
+      modulated planes of all orientations are interleaved by rows so that a single pass of the vectorized lowpass
+      kernels of env_simd_ops.h filters them all in y. Because the column and row phases are rounded separately, the
+      phase can differ by one trig table step from the one of env_steerable_filter(). Disjoint row bands can be
+      computed in parallel. */
+  void env_steerable_filter_bank(const struct env_image* src,
+                                 const env_size_t n,
+                                 const intg32* kxnumer, const intg32* kynumer,
+                                 const env_size_t kdenombits,
+                                 const struct env_math* imath,
+                                 const env_size_t r0, const env_size_t r1,
+                                 struct env_image* results);
   
   void env_pyr_build_hipass_9(const struct env_image* image,
                               env_size_t firstlevel,
@@ -105,6 +134,11 @@ extern "C"
                                const struct env_math* imath,
                                struct env_pyr* result);
   
+  //! Build the levels above a given level of a lowpass5 pyramid, from the image at that level
+  /*! Levels below lev are left untouched. This gives the same results as env_pyr_build_lowpass_5(), and is useful when
+      level lev has been obtained some other way, e.g., with env_pyr_rows (see env_pyr_rows.h). */
+  void env_pyr_build_lowpass_5_above(struct env_pyr* pyr, const env_size_t lev, const struct env_math* imath);
+  
   //! _cpu version implemented here, see CUDA/env_cuda.h for GPU version
   void env_pyr_build_lowpass_5_cpu(const struct env_image* image,
                                          env_size_t firstlevel,
@@ -129,6 +163,14 @@ extern "C"
                            const struct env_image* surround,
                            const int absol,
                            struct env_image* result);
+
+  /// Compute rows [y0..y1) of env_center_surround(), without the border attenuation
+  /// Different row ranges of the same result can be computed concurrently.
+  void env_center_surround_rows(const struct env_image* center,
+                                const struct env_image* surround,
+                                const int absol,
+                                struct env_image* result,
+                                const env_size_t y0, const env_size_t y1);
   
   /// Compute R-G and B-Y opponent color maps
   void env_get_rgby(const struct env_rgb_pixel* const src,
@@ -164,6 +206,27 @@ extern "C"
                        const env_size_t denombits,
                        struct env_image* result);
   
+  //! Compute where env_shift_image() reads each of its output pixels from, without computing the shifted image
+  void env_shift_taps_init(const struct env_dims dims,
+                           const env_ssize_t dxnumer, const env_ssize_t dynumer,
+                           const env_size_t denombits,
+                           struct env_shift_taps* taps);
+  
+  //! Get one pixel of the shifted image described by taps, where src points to the source pixel (x - xt, y - yt)
+  static inline intg32 env_shift_tap(const struct env_shift_taps* taps, const intg32* src, const env_ssize_t w);
+  
 #ifdef __cplusplus
 }
 #endif
+
+// ######################################################################
+static inline intg32 env_shift_tap(const struct env_shift_taps* taps, const intg32* src, const env_ssize_t w)
+{
+  if (taps->xfrac == 0 && taps->yfrac == 0) return src[0];
+  
+  const env_size_t db = taps->denombits;
+  const intg32 xf = taps->xfrac, yf = taps->yfrac, ixf = (1 << db) - xf, iyf = (1 << db) - yf;
+  
+  return (((src[0] >> db) * ixf) >> db) * iyf + (((src[1] >> db) * xf) >> db) * iyf
+    + (((src[w] >> db) * ixf) >> db) * yf + (((src[w+1] >> db) * xf) >> db) * yf;
+}
@@ -53,18 +53,13 @@ void env_motion_channel_init(struct env_motion_channel* chan,
 {
   env_pyr_init_empty(&chan->unshifted_prev);
   chan->num_directions = envp->num_motion_directions;
-  chan->shifted_prev = (struct env_pyr*)env_allocate(envp->num_motion_directions * sizeof(struct env_pyr));
-  for (env_size_t i = 0; i < envp->num_motion_directions; ++i) env_pyr_init_empty(&chan->shifted_prev[i]);
 }
 
 // ######################################################################
 void env_motion_channel_destroy(struct env_motion_channel* chan)
 {
   env_pyr_make_empty(&chan->unshifted_prev);
-  for (env_size_t i = 0; i < chan->num_directions; ++i) env_pyr_make_empty(&chan->shifted_prev[i]);
-  env_deallocate(chan->shifted_prev);
   chan->num_directions = 0;
-  chan->shifted_prev = 0;
 }
 
 // ######################################################################
@@ -88,9 +83,6 @@ void env_motion_channel_input_and_consume_pyr(struct env_motion_channel* chan,
   
   if (chan->num_directions == 0) return;
   
-  const env_size_t firstlevel = envp->cs_lev_min;
-  const env_size_t depth = env_max_pyr_depth(envp);
-  
   struct env_image chanOut = env_img_initializer;
   
   char buf[17] =
@@ -116,23 +108,8 @@ void env_motion_channel_input_and_consume_pyr(struct env_motion_channel* chan,
     buf[10] = '0' + ((dir+1) / 10);
     buf[11] = '0' + ((dir+1) % 10);
     
-    // create an empty pyramid
-    struct env_pyr shiftedCur;
-    env_pyr_init(&shiftedCur, depth);
-    
-    // fill the empty pyramid with the shifted version
-    for (env_size_t i = firstlevel; i < depth; ++i)
-    {
-      env_img_resize_dims(env_pyr_imgw(&shiftedCur, i), env_pyr_img(unshiftedCur, i)->dims);
-      env_shift_image(env_pyr_img(unshiftedCur, i), imath->costab[thetaidx], -imath->sintab[thetaidx],
-                      ENV_TRIG_NBITS, env_pyr_imgw(&shiftedCur, i));
-    }
-    
     env_chan_direction(buf, envp, imath, inputdims, &chan->unshifted_prev, unshiftedCur,
-                       &chan->shifted_prev[dir], &shiftedCur, status_func, status_userdata, &chanOut);
-    
-    env_pyr_swap(&chan->shifted_prev[dir], &shiftedCur);
-    env_pyr_make_empty(&shiftedCur);
+                       imath->costab[thetaidx], -imath->sintab[thetaidx], status_func, status_userdata, &chanOut);
     
     if (env_img_initialized(&chanOut))
     {
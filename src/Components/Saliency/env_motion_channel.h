@@ -53,7 +53,6 @@ struct env_motion_channel
 {
     struct env_pyr unshifted_prev;
     env_size_t num_directions;
-    struct env_pyr* shifted_prev;
 };
 
 #ifdef __cplusplus
@@ -67,6 +67,9 @@ void env_params_set_defaults(struct env_params* envp)
   envp->user_data_preproc = 0;
   envp->user_data_postnorm = 0;
   envp->user_data_postproc = 0;
+  envp->parallel_for = 0;
+  envp->user_data_parallel = 0;
+  envp->center_surround_rows = 0;
 }
 
 // ######################################################################
@@ -106,3 +109,13 @@ void env_params_validate(const struct env_params* envp)
   
   ENV_ASSERT(env_total_weight(envp) > 0);
 }
+
+// ######################################################################
+void env_parallel_for(const struct env_params* envp, env_size_t n, void (*job)(env_size_t i, void* job_data),
+                      void* job_data)
+{
+  if (n == 0) return;
+
+  if (envp->parallel_for != 0 && n > 1) (*envp->parallel_for)(n, job, job_data, envp->user_data_parallel);
+  else for (env_size_t i = 0; i < n; ++i) (*job)(i, job_data);
+}
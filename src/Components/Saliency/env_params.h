@@ -80,6 +80,21 @@ struct env_params
     void * user_data_preproc;
     void * user_data_postnorm;
     void * user_data_postproc;
+
+    //! Optional hook to run independent jobs in parallel, or null to run them sequentially in the calling thread
+    /*! Must call (*job)(i, job_data) exactly once for each i in [0..n), in any order and from any thread, and only
+        return once all these calls have returned. Jobs may themselves call parallel_for. When this hook is set, the
+        submap hooks above may be called concurrently for different submaps. */
+    void (*parallel_for)(env_size_t n, void (*job)(env_size_t i, void* job_data), void* job_data, void* user_data);
+    void * user_data_parallel;
+
+    //! Optional kernel computing rows [y0, y1) of a center-surround difference, or null to use the generic one
+    /*! Set by Saliency to kernels specialized at compile time for the common scale factors between center and
+        surround levels (see CenterSurroundKernel.H). Gets the arguments of env_center_surround_rows() and must give
+        the same results. The rest of the submap computation (parallel row bands, border attenuation, submap hooks,
+        resizing and max-normalization) is done by env_channel.c for both. */
+    void (*center_surround_rows)(const struct env_image* center, const struct env_image* surround, const int absol,
+                                 struct env_image* result, const env_size_t y0, const env_size_t y1);
 };
 
 #ifdef __cplusplus
@@ -96,6 +111,11 @@ extern "C"
   intg32 env_total_weight(const struct env_params* envp);
   
   void env_params_validate(const struct env_params* envp);
+
+  //! Run (*job)(i, job_data) for each i in [0..n), in parallel through envp->parallel_for if set
+  void env_parallel_for(const struct env_params* envp, env_size_t n, void (*job)(env_size_t i, void* job_data),
+                        void* job_data);
+  
   
 #ifdef __cplusplus
 }
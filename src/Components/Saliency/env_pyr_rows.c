@@ -0,0 +1,172 @@
+/*!@file Envision/env_pyr_rows.c Row-streaming construction of one level of a lowpass5 pyramid */
+
+// //////////////////////////////////////////////////////////////////// //
+// The iLab Neuromorphic Vision C++ Toolkit - Copyright (C) 2001 by the //
+// University of Southern California (USC) and the iLab at USC.         //
+// See http://iLab.usc.edu for information about this project.          //
+// //////////////////////////////////////////////////////////////////// //
+// Major portions of the iLab Neuromorphic Vision Toolkit are protected //
+// under the U.S. patent ``Computation of Intrinsic Perceptual Saliency //
+// in Visual Environments, and Applications'' by Christof Koch and      //
+// Laurent Itti, California Institute of Technology, 2001 (patent       //
+// pending; application number 09/912,225 filed July 23, 2001; see      //
+// http://pair.uspto.gov/cgi-bin/final/home.pl for current status).     //
+// //////////////////////////////////////////////////////////////////// //
+// This file is part of the iLab Neuromorphic Vision C++ Toolkit.       //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is free software; you can   //
+// redistribute it and/or modify it under the terms of the GNU General  //
+// Public License as published by the Free Software Foundation; either  //
+// version 2 of the License, or (at your option) any later version.     //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is distributed in the hope  //
+// that it will be useful, but WITHOUT ANY WARRANTY; without even the   //
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR      //
+// PURPOSE.  See the GNU General Public License for more details.       //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with the iLab Neuromorphic Vision C++ Toolkit; if not, write   //
+// to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,   //
+// Boston, MA 02111-1307 USA.                                           //
+// //////////////////////////////////////////////////////////////////// //
+//
+
+#include <jevoisbase/src/Components/Saliency/env_pyr_rows.h>
+
+#include <jevoisbase/src/Components/Saliency/env_c_math_ops.h>
+#include <jevoisbase/src/Components/Saliency/env_log.h>
+
+// ######################################################################
+struct env_dims env_pyr_rows_dims(const struct env_dims dims, const env_size_t level)
+{
+  struct env_dims d = dims;
+
+  // env_lowpass_5_x_dec_x() and env_lowpass_5_y_dec_y() just copy images that are smaller than 2 pixels:
+  for (env_size_t i = 0; i < level; ++i)
+  {
+    if (d.w >= 2) d.w /= 2;
+    if (d.h >= 2) d.h /= 2;
+  }
+  return d;
+}
+
+// ######################################################################
+// Last row of the level below that is needed to compute row j, for a level below of height h
+static env_size_t env_pyr_rows_last_needed(const env_size_t h, const env_size_t j)
+{
+  if (h < 2) return 0;        // copy
+  if (h < 4) return 1;        // single output row [ (6^) 4 ] / 10
+  return (j == 0) ? 1 : 2*j + 1; // [ (8^) 4 ] / 12, then [ .^ 4 (8) 4 ] / 16
+}
+
+// ######################################################################
+void env_pyr_rows_init(struct env_pyr_rows* s, const struct env_dims dims, const env_size_t level,
+                       const env_size_t row0, const env_size_t row1, intg32* out)
+{
+  ENV_ASSERT(level < ENV_PYR_ROWS_MAXLEV);
+  
+  s->level = level;
+  s->out = out;
+
+  for (env_size_t l = 0; l <= level; ++l)
+  {
+    s->lev[l].dims = env_pyr_rows_dims(dims, l);
+    s->lev[l].ring = 0;
+    s->lev[l].row = 0;
+  }
+
+  ENV_ASSERT(row0 <= row1 && row1 <= s->lev[level].dims.h);
+  
+  // Go down the levels to find which rows are needed to compute our rows:
+  s->lev[level].row0 = row0; s->lev[level].row1 = row1;
+
+  for (env_size_t l = level; l > 0; --l)
+  {
+    struct env_pyr_rows_level* const cur = &s->lev[l];
+    struct env_pyr_rows_level* const below = &s->lev[l-1];
+
+    if (cur->row0 == cur->row1) { below->row0 = below->row1 = 0; continue; }
+
+    below->row0 = (cur->row0 == 0 || below->dims.h < 4) ? 0 : 2 * cur->row0 - 1;
+    below->row1 = env_pyr_rows_last_needed(below->dims.h, cur->row1 - 1) + 1;
+  }
+
+  for (env_size_t l = 0; l <= level; ++l)
+  {
+    s->lev[l].next = s->lev[l].row0;
+    if (l > 0) s->lev[l].ring = (intg32*) env_allocate(3 * s->lev[l].dims.w * sizeof(intg32));
+    if (l > 0 && l < level) s->lev[l].row = (intg32*) env_allocate(s->lev[l].dims.w * sizeof(intg32));
+  }
+}
+
+// ######################################################################
+void env_pyr_rows_destroy(struct env_pyr_rows* s)
+{
+  for (env_size_t l = 0; l <= s->level; ++l)
+  {
+    env_deallocate(s->lev[l].ring); s->lev[l].ring = 0;
+    env_deallocate(s->lev[l].row); s->lev[l].row = 0;
+  }
+}
+
+// ######################################################################
+// Process row lev[l].next of level l, which has just been computed
+static void env_pyr_rows_emit(struct env_pyr_rows* s, const env_size_t l, const intg32* row)
+{
+  const env_size_t idx = s->lev[l].next++;
+
+  if (l == s->level) return; // the row is already in our output image
+
+  // Decimate the row in x into the ring of the level above:
+  struct env_pyr_rows_level* const up = &s->lev[l+1];
+  const env_size_t w = s->lev[l].dims.w, h = s->lev[l].dims.h, w2 = up->dims.w;
+  intg32* const xrow = up->ring + (idx % 3) * w2;
+
+  if (w < 2) xrow[0] = row[0];
+  else env_c_lowpass_5_x_dec_x_fewbits_optim(row, w, 1, xrow, w2);
+
+  // Then compute all the rows of the level above that are now ready, see env_c_lowpass_5_y_dec_y_fewbits_optim():
+  while (up->next < up->row1 && env_pyr_rows_last_needed(h, up->next) <= idx)
+  {
+    const env_size_t j = up->next;
+    intg32* const dst = (l+1 == s->level) ? s->out + j * w2 : up->row;
+
+    if (h < 2)
+      for (env_size_t i = 0; i < w2; ++i) dst[i] = up->ring[i];
+    else if (h < 4)
+    {
+      const intg32* const r0 = up->ring; const intg32* const r1 = up->ring + w2;
+      for (env_size_t i = 0; i < w2; ++i) dst[i] = (r0[i] * 3 + r1[i] * 2) / 5;
+    }
+    else if (j == 0)
+    {
+      const intg32* const r0 = up->ring; const intg32* const r1 = up->ring + w2;
+      for (env_size_t i = 0; i < w2; ++i) dst[i] = (r0[i] * 2 + r1[i]) / 3;
+    }
+    else
+    {
+      const intg32* const r1 = up->ring + ((2*j - 1) % 3) * w2;
+      const intg32* const r2 = up->ring + ((2*j) % 3) * w2;
+      const intg32* const r3 = up->ring + ((2*j + 1) % 3) * w2;
+      for (env_size_t i = 0; i < w2; ++i) dst[i] = (r1[i] + r3[i] + r2[i] * 2) >> 2;
+    }
+
+    env_pyr_rows_emit(s, l+1, dst);
+  }
+}
+
+// ######################################################################
+void env_pyr_rows_push(struct env_pyr_rows* s, const intg32* row)
+{
+  struct env_pyr_rows_level* const lev0 = &s->lev[0];
+  ENV_ASSERT(lev0->next < lev0->row1);
+
+  // At level 0, the output is a copy of the input:
+  if (s->level == 0)
+  {
+    intg32* const dst = s->out + lev0->next * lev0->dims.w;
+    for (env_size_t i = 0; i < lev0->dims.w; ++i) dst[i] = row[i];
+  }
+
+  env_pyr_rows_emit(s, 0, row);
+}
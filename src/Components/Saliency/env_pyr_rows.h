@@ -0,0 +1,109 @@
+/*!@file Envision/env_pyr_rows.h Row-streaming construction of one level of a lowpass5 pyramid */
+
+// //////////////////////////////////////////////////////////////////// //
+// The iLab Neuromorphic Vision C++ Toolkit - Copyright (C) 2001 by the //
+// University of Southern California (USC) and the iLab at USC.         //
+// See http://iLab.usc.edu for information about this project.          //
+// //////////////////////////////////////////////////////////////////// //
+// Major portions of the iLab Neuromorphic Vision Toolkit are protected //
+// under the U.S. patent ``Computation of Intrinsic Perceptual Saliency //
+// in Visual Environments, and Applications'' by Christof Koch and      //
+// Laurent Itti, California Institute of Technology, 2001 (patent       //
+// pending; application number 09/912,225 filed July 23, 2001; see      //
+// http://pair.uspto.gov/cgi-bin/final/home.pl for current status).     //
+// //////////////////////////////////////////////////////////////////// //
+// This file is part of the iLab Neuromorphic Vision C++ Toolkit.       //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is free software; you can   //
+// redistribute it and/or modify it under the terms of the GNU General  //
+// Public License as published by the Free Software Foundation; either  //
+// version 2 of the License, or (at your option) any later version.     //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is distributed in the hope  //
+// that it will be useful, but WITHOUT ANY WARRANTY; without even the   //
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR      //
+// PURPOSE.  See the GNU General Public License for more details.       //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with the iLab Neuromorphic Vision C++ Toolkit; if not, write   //
+// to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,   //
+// Boston, MA 02111-1307 USA.                                           //
+// //////////////////////////////////////////////////////////////////// //
+//
+
+#pragma once
+
+#include <jevoisbase/src/Components/Saliency/env_config.h>
+#include <jevoisbase/src/Components/Saliency/env_image.h>
+#include <jevoisbase/src/Components/Saliency/env_types.h>
+
+//! Max pyramid level that can be computed by env_pyr_rows, plus one
+#define ENV_PYR_ROWS_MAXLEV ((env_size_t) 16)
+
+//! State of one pyramid level in env_pyr_rows
+struct env_pyr_rows_level
+{
+    struct env_dims dims; //!< Dims of the full image at this level
+    env_size_t row0;      //!< First row of this level that we compute
+    env_size_t row1;      //!< One past the last row of this level that we compute
+    env_size_t next;      //!< Next row of this level to be computed (or pushed, for level 0)
+    intg32* ring;         //!< Last 3 rows of the level below, already decimated in x (levels > 0 only)
+    intg32* row;          //!< Scratch row for levels between 0 and the target level
+};
+
+//! Row-streaming computation of some rows of one level of a lowpass5 pyramid
+/*! Gives the same results as env_pyr_build_lowpass_5(), but for only one level and only some rows of it, from input
+    rows that are pushed one at a time. Only 3 rows per intermediate level are kept, so the full-resolution input image
+    and the intermediate levels never need to exist in memory. This allows, e.g., converting a camera frame one row at
+    a time and directly getting the first pyramid level that is used by the channels. Several env_pyr_rows working on
+    disjoint row ranges of the same output level can run in parallel, each one just needs a few more input rows than
+    its share. */
+struct env_pyr_rows
+{
+    env_size_t level; //!< Level that we compute
+    intg32* out;      //!< Pixels of the full image at that level, we only write our rows
+    struct env_pyr_rows_level lev[ENV_PYR_ROWS_MAXLEV];
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  //! Get the dims of a given level of a lowpass5 pyramid built from an image of given dims
+  struct env_dims env_pyr_rows_dims(const struct env_dims dims, const env_size_t level);
+
+  //! Initialize for the computation of rows [row0, row1) of the given level
+  /*! dims are those of the level 0 image, and out should point to the pixels of an image of dims
+      env_pyr_rows_dims(dims, level). Rows env_pyr_rows_first() to env_pyr_rows_end() of the level 0 image should then
+      be pushed, in order. */
+  void env_pyr_rows_init(struct env_pyr_rows* s, const struct env_dims dims, const env_size_t level,
+                         const env_size_t row0, const env_size_t row1, intg32* out);
+
+  //! Free our internal buffers
+  void env_pyr_rows_destroy(struct env_pyr_rows* s);
+
+  //! Push the next row of the level 0 image, computing any output row that becomes ready
+  void env_pyr_rows_push(struct env_pyr_rows* s, const intg32* row);
+
+  //! First row of the level 0 image that should be pushed
+  static inline env_size_t env_pyr_rows_first(const struct env_pyr_rows* s);
+
+  //! One past the last row of the level 0 image that should be pushed
+  static inline env_size_t env_pyr_rows_end(const struct env_pyr_rows* s);
+
+#ifdef __cplusplus
+}
+#endif
+
+// ######################################################################
+static inline env_size_t env_pyr_rows_first(const struct env_pyr_rows* s)
+{
+  return s->lev[0].row0;
+}
+
+// ######################################################################
+static inline env_size_t env_pyr_rows_end(const struct env_pyr_rows* s)
+{
+  return s->lev[0].row1;
+}
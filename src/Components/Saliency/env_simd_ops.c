@@ -0,0 +1,1169 @@
+/*!@file Envision/env_simd_ops.c Vectorized inner loops of the fixed-point lowpass, steerable and 16-bit filters */
+
+// //////////////////////////////////////////////////////////////////// //
+// The iLab Neuromorphic Vision C++ Toolkit - Copyright (C) 2001 by the //
+// University of Southern California (USC) and the iLab at USC.         //
+// See http://iLab.usc.edu for information about this project.          //
+// //////////////////////////////////////////////////////////////////// //
+// Major portions of the iLab Neuromorphic Vision Toolkit are protected //
+// under the U.S. patent ``Computation of Intrinsic Perceptual Saliency //
+// in Visual Environments, and Applications'' by Christof Koch and      //
+// Laurent Itti, California Institute of Technology, 2001 (patent       //
+// pending; application number 09/912,225 filed July 23, 2001; see      //
+// http://pair.uspto.gov/cgi-bin/final/home.pl for current status).     //
+// //////////////////////////////////////////////////////////////////// //
+// This file is part of the iLab Neuromorphic Vision C++ Toolkit.       //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is free software; you can   //
+// redistribute it and/or modify it under the terms of the GNU General  //
+// Public License as published by the Free Software Foundation; either  //
+// version 2 of the License, or (at your option) any later version.     //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is distributed in the hope  //
+// that it will be useful, but WITHOUT ANY WARRANTY; without even the   //
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR      //
+// PURPOSE.  See the GNU General Public License for more details.       //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with the iLab Neuromorphic Vision C++ Toolkit; if not, write   //
+// to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,   //
+// Boston, MA 02111-1307 USA.                                           //
+// //////////////////////////////////////////////////////////////////// //
+//
+
+#include <jevoisbase/src/Components/Saliency/env_simd_ops.h>
+#include <jevoisbase/src/Components/Saliency/env_image16.h>
+#include <jevoisbase/src/Components/Saliency/env_math.h>
+
+// All the kernels below are bit-exact with the scalar code in env_c_math_ops.c, env_image_ops.c and
+// env_image16_ops.c: the multiplications by the filter coefficients are done as shifts and adds, which give the same
+// results modulo 2^32 as the scalar integer arithmetic, and the final divisions by powers of two are arithmetic right
+// shifts, as is the case for the scalar code with gcc.
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define ENV_SIMD_X86 1
+#  include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define ENV_SIMD_ARM 1
+#  include <arm_neon.h>
+#endif
+
+// Defined by the platform build, which must not silently fall back to the scalar code:
+#if defined(ENV_SIMD_REQUIRE_NEON) && !defined(ENV_SIMD_ARM)
+#  error "NEON kernels required but the compiler does not target NEON, check the -mfpu flags"
+#endif
+
+static enum env_simd_level g_simd_level = ENV_SIMD_NONE;
+
+// ######################################################################
+static enum env_simd_level env_simd_best_level(void)
+{
+#if defined(ENV_SIMD_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return ENV_SIMD_AVX2;
+  if (__builtin_cpu_supports("sse2")) return ENV_SIMD_SSE2;
+  return ENV_SIMD_NONE;
+#elif defined(ENV_SIMD_ARM)
+  return ENV_SIMD_NEON;
+#else
+  return ENV_SIMD_NONE;
+#endif
+}
+
+// ######################################################################
+__attribute__((constructor)) static void env_simd_init(void)
+{
+  g_simd_level = env_simd_best_level();
+}
+
+// ######################################################################
+enum env_simd_level env_simd_get_level(void)
+{
+  return g_simd_level;
+}
+
+// ######################################################################
+enum env_simd_level env_simd_set_level(const enum env_simd_level level)
+{
+  const enum env_simd_level best = env_simd_best_level();
+
+  if (level == ENV_SIMD_NONE || level == best) g_simd_level = level;
+#if defined(ENV_SIMD_X86)
+  else if (level == ENV_SIMD_SSE2 && best == ENV_SIMD_AVX2) g_simd_level = level;
+#endif
+  else g_simd_level = ENV_SIMD_NONE;
+
+  return g_simd_level;
+}
+
+#if defined(ENV_SIMD_X86)
+
+// ######################################################################
+// ########## SSE2
+// ######################################################################
+
+// Even and odd elements of 8 consecutive values:
+#define ENV_SSE2_EVEN(a, b) _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), \
+                                                            _MM_SHUFFLE(2, 0, 2, 0)))
+#define ENV_SSE2_ODD(a, b) _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), \
+                                                           _MM_SHUFFLE(3, 1, 3, 1)))
+
+// ######################################################################
+__attribute__((target("sse2")))
+static inline __m128i env_sse2_lowpass_9_vec(const intg32* s, const env_size_t st)
+{
+  const __m128i a06 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(s)),
+                                    _mm_loadu_si128((const __m128i*)(s + 6 * st)));
+  const __m128i a15 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(s + st)),
+                                    _mm_loadu_si128((const __m128i*)(s + 5 * st)));
+  const __m128i a24 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(s + 2 * st)),
+                                    _mm_loadu_si128((const __m128i*)(s + 4 * st)));
+  const __m128i a3 = _mm_loadu_si128((const __m128i*)(s + 3 * st));
+
+  // 8*a06 + (32-4)*a15 + (64-8)*a24 + (64+8)*a3:
+  __m128i r = _mm_slli_epi32(_mm_add_epi32(a06, _mm_sub_epi32(a3, a24)), 3);
+  r = _mm_add_epi32(r, _mm_sub_epi32(_mm_slli_epi32(a15, 5), _mm_slli_epi32(a15, 2)));
+  r = _mm_add_epi32(r, _mm_slli_epi32(_mm_add_epi32(a24, a3), 6));
+
+  return _mm_srai_epi32(r, 8);
+}
+
+// ######################################################################
+__attribute__((target("sse2")))
+static env_size_t env_sse2_lowpass_9(const intg32* src, const env_size_t stride, intg32* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 4 <= n; k += 4) _mm_storeu_si128((__m128i*)(dst + k), env_sse2_lowpass_9_vec(src + k, stride));
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("sse2")))
+static env_size_t env_sse2_lowpass_5_x_dec(const intg32* src, intg32* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 5 <= n; k += 4)
+  {
+    const intg32* s = src + 2 * k;
+    const __m128i a = _mm_loadu_si128((const __m128i*)(s + 1)), b = _mm_loadu_si128((const __m128i*)(s + 5));
+    const __m128i c = _mm_loadu_si128((const __m128i*)(s + 3)), d = _mm_loadu_si128((const __m128i*)(s + 7));
+
+    const __m128i r = _mm_add_epi32(_mm_add_epi32(ENV_SSE2_EVEN(a, b), ENV_SSE2_EVEN(c, d)),
+                                    _mm_slli_epi32(ENV_SSE2_ODD(a, b), 1));
+    _mm_storeu_si128((__m128i*)(dst + k), _mm_srai_epi32(r, 2));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("sse2")))
+static env_size_t env_sse2_lowpass_5_y_dec(const intg32* src, const env_size_t w, intg32* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 4 <= n; k += 4)
+  {
+    const intg32* s = src + k;
+    const __m128i r = _mm_add_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i*)(s + w)),
+                                                  _mm_loadu_si128((const __m128i*)(s + 3 * w))),
+                                    _mm_slli_epi32(_mm_loadu_si128((const __m128i*)(s + 2 * w)), 1));
+    _mm_storeu_si128((__m128i*)(dst + k), _mm_srai_epi32(r, 2));
+  }
+  return k;
+}
+
+// ######################################################################
+// ########## SSE2, 16-bit pixels
+// ######################################################################
+
+// The 16-bit filters multiply pairs of interleaved pixels by pairs of coefficients with madd, which gives exact 32-bit
+// sums, and pack the results back to 16 bits with saturation after the final shift. Since the filters compute weighted
+// averages, the packing never saturates, as is the case for the (intg16) casts of the scalar code.
+
+#define ENV_SSE2_LD(p) _mm_loadu_si128((const __m128i*)(p))
+#define ENV_SSE2_ST(p, v) _mm_storeu_si128((__m128i*)(p), (v))
+
+// ######################################################################
+// (c0, c1) coefficient pairs for madd:
+#define ENV_SSE2_PAIR(c0, c1) _mm_set1_epi32((intg32) (((c1) << 16) | (c0)))
+
+// ######################################################################
+__attribute__((target("sse2")))
+static inline __m128i env_sse2_lowpass_9_vec16(const intg16* s, const env_size_t st)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i c06 = ENV_SSE2_PAIR(8, 8), c15 = ENV_SSE2_PAIR(28, 28), c24 = ENV_SSE2_PAIR(56, 56);
+  const __m128i c3 = ENV_SSE2_PAIR(72, 0);
+
+  const __m128i s0 = ENV_SSE2_LD(s), s1 = ENV_SSE2_LD(s + st), s2 = ENV_SSE2_LD(s + 2 * st);
+  const __m128i s3 = ENV_SSE2_LD(s + 3 * st), s4 = ENV_SSE2_LD(s + 4 * st), s5 = ENV_SSE2_LD(s + 5 * st);
+  const __m128i s6 = ENV_SSE2_LD(s + 6 * st);
+
+  __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(s0, s6), c06),
+                             _mm_madd_epi16(_mm_unpacklo_epi16(s1, s5), c15));
+  lo = _mm_add_epi32(lo, _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(s2, s4), c24),
+                                       _mm_madd_epi16(_mm_unpacklo_epi16(s3, zero), c3)));
+  __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(s0, s6), c06),
+                             _mm_madd_epi16(_mm_unpackhi_epi16(s1, s5), c15));
+  hi = _mm_add_epi32(hi, _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(s2, s4), c24),
+                                       _mm_madd_epi16(_mm_unpackhi_epi16(s3, zero), c3)));
+
+  return _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+}
+
+// ######################################################################
+__attribute__((target("sse2")))
+static env_size_t env_sse2_lowpass_9_16(const intg16* src, const env_size_t stride, intg16* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8) ENV_SSE2_ST(dst + k, env_sse2_lowpass_9_vec16(src + k, stride));
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("sse2")))
+static env_size_t env_sse2_lowpass_5_x_dec16(const intg16* src, intg16* dst, const env_size_t n)
+{
+  const __m128i c12 = ENV_SSE2_PAIR(1, 2), c10 = ENV_SSE2_PAIR(1, 0);
+
+  env_size_t k = 0;
+  for (; k + 9 <= n; k += 8)
+  {
+    // Pairs (s[2k+1], s[2k+2]) weighted by (1, 2), plus pairs (s[2k+3], s[2k+4]) weighted by (1, 0):
+    const intg16* s = src + 2 * k;
+    const __m128i lo = _mm_add_epi32(_mm_madd_epi16(ENV_SSE2_LD(s + 1), c12), _mm_madd_epi16(ENV_SSE2_LD(s + 3), c10));
+    const __m128i hi = _mm_add_epi32(_mm_madd_epi16(ENV_SSE2_LD(s + 9), c12), _mm_madd_epi16(ENV_SSE2_LD(s + 11), c10));
+    ENV_SSE2_ST(dst + k, _mm_packs_epi32(_mm_srai_epi32(lo, 2), _mm_srai_epi32(hi, 2)));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("sse2")))
+static env_size_t env_sse2_lowpass_5_y_dec16(const intg16* src, const env_size_t w, intg16* dst, const env_size_t n)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i c12 = ENV_SSE2_PAIR(1, 2), c10 = ENV_SSE2_PAIR(1, 0);
+
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const intg16* s = src + k;
+    const __m128i s1 = ENV_SSE2_LD(s + w), s2 = ENV_SSE2_LD(s + 2 * w), s3 = ENV_SSE2_LD(s + 3 * w);
+    const __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(s1, s2), c12),
+                                     _mm_madd_epi16(_mm_unpacklo_epi16(s3, zero), c10));
+    const __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(s1, s2), c12),
+                                     _mm_madd_epi16(_mm_unpackhi_epi16(s3, zero), c10));
+    ENV_SSE2_ST(dst + k, _mm_packs_epi32(_mm_srai_epi32(lo, 2), _mm_srai_epi32(hi, 2)));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("sse2")))
+static env_size_t env_sse2_sub_sat16(const intg16* a, const intg16* b, intg16* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8) ENV_SSE2_ST(dst + k, _mm_subs_epi16(ENV_SSE2_LD(a + k), ENV_SSE2_LD(b + k)));
+  return k;
+}
+
+// ######################################################################
+// The absolute value of -32768 saturates to 32767 instead of 32768, which does not change the result since the scalar
+// code then saturates its sum to 32767 anyway:
+__attribute__((target("sse2")))
+static env_size_t env_sse2_quad_energy16(const intg16* a, const intg16* b, intg16* dst, const env_size_t n)
+{
+  const __m128i zero = _mm_setzero_si128();
+
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const __m128i va = ENV_SSE2_LD(a + k), vb = ENV_SSE2_LD(b + k);
+    const __m128i s1 = _mm_max_epi16(va, _mm_subs_epi16(zero, va));
+    const __m128i s2 = _mm_max_epi16(vb, _mm_subs_epi16(zero, vb));
+    const __m128i gt = _mm_cmpgt_epi16(s1, s2);
+
+    // s1 + (s2 >> 1) where s1 > s2, (s1 >> 1) + s2 elsewhere:
+    const __m128i x = _mm_or_si128(_mm_and_si128(gt, s1), _mm_andnot_si128(gt, _mm_srai_epi16(s1, 1)));
+    const __m128i y = _mm_or_si128(_mm_and_si128(gt, _mm_srai_epi16(s2, 1)), _mm_andnot_si128(gt, s2));
+    ENV_SSE2_ST(dst + k, _mm_adds_epi16(x, y));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("sse2")))
+static env_size_t env_sse2_center_surround16(const intg16* c, const intg16* s, const int absol, intg16* dst,
+                                             const env_size_t n)
+{
+  env_size_t k = 0;
+  if (absol)
+    for (; k + 8 <= n; k += 8)
+    {
+      const __m128i vc = ENV_SSE2_LD(c + k), vs = ENV_SSE2_LD(s + k);
+      ENV_SSE2_ST(dst + k, _mm_max_epi16(_mm_subs_epi16(vc, vs), _mm_subs_epi16(vs, vc)));
+    }
+  else
+  {
+    const __m128i zero = _mm_setzero_si128();
+    for (; k + 8 <= n; k += 8)
+      ENV_SSE2_ST(dst + k, _mm_max_epi16(_mm_subs_epi16(ENV_SSE2_LD(c + k), ENV_SSE2_LD(s + k)), zero));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("sse2")))
+static env_size_t env_sse2_clamp_minmax16(intg16* p, const env_size_t n, intg16* mi, intg16* ma)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i vmi = _mm_set1_epi16(INTG16_MAX), vma = zero;
+
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const __m128i v = _mm_max_epi16(ENV_SSE2_LD(p + k), zero);
+    ENV_SSE2_ST(p + k, v);
+    vmi = _mm_min_epi16(vmi, v); vma = _mm_max_epi16(vma, v);
+  }
+
+  if (k)
+  {
+    intg16 tmi[8], tma[8];
+    ENV_SSE2_ST(tmi, vmi); ENV_SSE2_ST(tma, vma);
+    *mi = tmi[0]; *ma = tma[0];
+    for (int i = 1; i < 8; ++i) { *mi = ENV_MIN(*mi, tmi[i]); *ma = ENV_MAX(*ma, tma[i]); }
+  }
+  return k;
+}
+
+// ######################################################################
+// d * factor >> 16 is computed as d * (factor >> 16) + ((d * (factor & 0xffff)) >> 16), where the first product fits
+// in 16 bits since the result does:
+__attribute__((target("sse2")))
+static env_size_t env_sse2_normalize16(intg16* p, const env_size_t n, const intg16 mi, const intg16 nmin,
+                                       const intg32 factor)
+{
+  const __m128i vmi = _mm_set1_epi16(mi), vnmin = _mm_set1_epi16(nmin);
+  const __m128i fh = _mm_set1_epi16((intg16) (factor >> 16)), fl = _mm_set1_epi16((intg16) (factor & 0xffff));
+
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const __m128i d = _mm_sub_epi16(ENV_SSE2_LD(p + k), vmi);
+    ENV_SSE2_ST(p + k, _mm_add_epi16(vnmin, _mm_add_epi16(_mm_mullo_epi16(d, fh), _mm_mulhi_epu16(d, fl))));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("sse2")))
+static env_size_t env_sse2_local_max16(const intg16* p, const env_size_t w, const intg16 thresh, const env_size_t n,
+                                       env_size_t* numlm, intg32* lmsum)
+{
+  const __m128i th = _mm_set1_epi16(thresh), ones = _mm_set1_epi16(1);
+  __m128i sum = _mm_setzero_si128(), cnt = _mm_setzero_si128();
+
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const intg16* q = p + k;
+    const __m128i v = ENV_SSE2_LD(q);
+    const __m128i nb = _mm_max_epi16(_mm_max_epi16(ENV_SSE2_LD(q - 1), ENV_SSE2_LD(q + 1)),
+                                     _mm_max_epi16(ENV_SSE2_LD(q - w), ENV_SSE2_LD(q + w)));
+    const __m128i lm = _mm_cmpeq_epi16(_mm_max_epi16(v, _mm_max_epi16(nb, th)), v); // all ones where v >= all
+
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_and_si128(v, lm), ones));
+    cnt = _mm_sub_epi16(cnt, lm);
+  }
+
+  if (k)
+  {
+    intg32 tsum[4]; intg16 tcnt[8];
+    ENV_SSE2_ST(tsum, sum); ENV_SSE2_ST(tcnt, cnt);
+    for (int i = 0; i < 4; ++i) *lmsum += tsum[i];
+    for (int i = 0; i < 8; ++i) *numlm += (env_size_t) tcnt[i];
+  }
+  return k;
+}
+
+// ######################################################################
+// ########## AVX2
+// ######################################################################
+
+// ######################################################################
+__attribute__((target("avx2")))
+static inline __m256i env_avx2_lowpass_9_vec(const intg32* s, const env_size_t st)
+{
+  const __m256i a06 = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(s)),
+                                       _mm256_loadu_si256((const __m256i*)(s + 6 * st)));
+  const __m256i a15 = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(s + st)),
+                                       _mm256_loadu_si256((const __m256i*)(s + 5 * st)));
+  const __m256i a24 = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(s + 2 * st)),
+                                       _mm256_loadu_si256((const __m256i*)(s + 4 * st)));
+  const __m256i a3 = _mm256_loadu_si256((const __m256i*)(s + 3 * st));
+
+  __m256i r = _mm256_slli_epi32(_mm256_add_epi32(a06, _mm256_sub_epi32(a3, a24)), 3);
+  r = _mm256_add_epi32(r, _mm256_sub_epi32(_mm256_slli_epi32(a15, 5), _mm256_slli_epi32(a15, 2)));
+  r = _mm256_add_epi32(r, _mm256_slli_epi32(_mm256_add_epi32(a24, a3), 6));
+
+  return _mm256_srai_epi32(r, 8);
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_lowpass_9(const intg32* src, const env_size_t stride, intg32* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8) _mm256_storeu_si256((__m256i*)(dst + k), env_avx2_lowpass_9_vec(src + k, stride));
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_steerable_modulate(const intg32* src, const intg32* xa, const intg32* xb, const intg32 ya,
+                                              const intg32 yb, intg32* dst, const env_size_t n)
+{
+  const __m256i rnd = _mm256_set1_epi32(1 << (ENV_TRIG_NBITS - 1));
+  const __m256i yav = _mm256_set1_epi32(ya), ybv = _mm256_set1_epi32(yb);
+
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const __m256i ta = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(xa + k)), yav);
+    const __m256i tb = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(xb + k)), ybv);
+    const __m256i t = _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(ta, tb), rnd), ENV_TRIG_NBITS);
+    const __m256i m = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(src + k)), t);
+    _mm256_storeu_si256((__m256i*)(dst + k), _mm256_srai_epi32(m, ENV_TRIG_NBITS + 1));
+  }
+  return k;
+}
+
+// ######################################################################
+// Even elements of 16 consecutive values in the low half of the result, odd ones in the high half:
+__attribute__((target("avx2")))
+static inline void env_avx2_deinterleave(const intg32* s, __m256i* even, __m256i* odd)
+{
+  const __m256i idx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+  const __m256i a = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)(s)), idx);
+  const __m256i b = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)(s + 8)), idx);
+  *even = _mm256_permute2x128_si256(a, b, 0x20);
+  *odd = _mm256_permute2x128_si256(a, b, 0x31);
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_lowpass_5_x_dec(const intg32* src, intg32* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 9 <= n; k += 8)
+  {
+    const intg32* s = src + 2 * k;
+    __m256i e1, o1, e3, o3;
+    env_avx2_deinterleave(s + 1, &e1, &o1);
+    env_avx2_deinterleave(s + 3, &e3, &o3);
+
+    const __m256i r = _mm256_add_epi32(_mm256_add_epi32(e1, e3), _mm256_slli_epi32(o1, 1));
+    _mm256_storeu_si256((__m256i*)(dst + k), _mm256_srai_epi32(r, 2));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_lowpass_5_y_dec(const intg32* src, const env_size_t w, intg32* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const intg32* s = src + k;
+    const __m256i r = _mm256_add_epi32(_mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(s + w)),
+                                                        _mm256_loadu_si256((const __m256i*)(s + 3 * w))),
+                                       _mm256_slli_epi32(_mm256_loadu_si256((const __m256i*)(s + 2 * w)), 1));
+    _mm256_storeu_si256((__m256i*)(dst + k), _mm256_srai_epi32(r, 2));
+  }
+  return k;
+}
+
+
+// ######################################################################
+// ########## AVX2, 16-bit pixels
+// ######################################################################
+
+// Same computations as the SSE2 ones. unpacklo/unpackhi and packs work within each 128-bit lane, so that the outputs
+// come out in order when both are used, but not after the deinterleaving loads of the decimating filter.
+
+#define ENV_AVX2_LD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define ENV_AVX2_ST(p, v) _mm256_storeu_si256((__m256i*)(p), (v))
+#define ENV_AVX2_PAIR(c0, c1) _mm256_set1_epi32((intg32) (((c1) << 16) | (c0)))
+
+// ######################################################################
+__attribute__((target("avx2")))
+static inline __m256i env_avx2_lowpass_9_vec16(const intg16* s, const env_size_t st)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i c06 = ENV_AVX2_PAIR(8, 8), c15 = ENV_AVX2_PAIR(28, 28), c24 = ENV_AVX2_PAIR(56, 56);
+  const __m256i c3 = ENV_AVX2_PAIR(72, 0);
+
+  const __m256i s0 = ENV_AVX2_LD(s), s1 = ENV_AVX2_LD(s + st), s2 = ENV_AVX2_LD(s + 2 * st);
+  const __m256i s3 = ENV_AVX2_LD(s + 3 * st), s4 = ENV_AVX2_LD(s + 4 * st), s5 = ENV_AVX2_LD(s + 5 * st);
+  const __m256i s6 = ENV_AVX2_LD(s + 6 * st);
+
+  __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(s0, s6), c06),
+                                _mm256_madd_epi16(_mm256_unpacklo_epi16(s1, s5), c15));
+  lo = _mm256_add_epi32(lo, _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(s2, s4), c24),
+                                             _mm256_madd_epi16(_mm256_unpacklo_epi16(s3, zero), c3)));
+  __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(s0, s6), c06),
+                                _mm256_madd_epi16(_mm256_unpackhi_epi16(s1, s5), c15));
+  hi = _mm256_add_epi32(hi, _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(s2, s4), c24),
+                                             _mm256_madd_epi16(_mm256_unpackhi_epi16(s3, zero), c3)));
+
+  return _mm256_packs_epi32(_mm256_srai_epi32(lo, 8), _mm256_srai_epi32(hi, 8));
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_lowpass_9_16(const intg16* src, const env_size_t stride, intg16* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 16 <= n; k += 16) ENV_AVX2_ST(dst + k, env_avx2_lowpass_9_vec16(src + k, stride));
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_lowpass_5_x_dec16(const intg16* src, intg16* dst, const env_size_t n)
+{
+  const __m256i c12 = ENV_AVX2_PAIR(1, 2), c10 = ENV_AVX2_PAIR(1, 0);
+
+  env_size_t k = 0;
+  for (; k + 17 <= n; k += 16)
+  {
+    const intg16* s = src + 2 * k;
+    const __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(ENV_AVX2_LD(s + 1), c12),
+                                        _mm256_madd_epi16(ENV_AVX2_LD(s + 3), c10));
+    const __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(ENV_AVX2_LD(s + 17), c12),
+                                        _mm256_madd_epi16(ENV_AVX2_LD(s + 19), c10));
+
+    // lo holds outputs 0..7 and hi 8..15, which packs interleaves by groups of 4:
+    const __m256i r = _mm256_packs_epi32(_mm256_srai_epi32(lo, 2), _mm256_srai_epi32(hi, 2));
+    ENV_AVX2_ST(dst + k, _mm256_permute4x64_epi64(r, _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_lowpass_5_y_dec16(const intg16* src, const env_size_t w, intg16* dst, const env_size_t n)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i c12 = ENV_AVX2_PAIR(1, 2), c10 = ENV_AVX2_PAIR(1, 0);
+
+  env_size_t k = 0;
+  for (; k + 16 <= n; k += 16)
+  {
+    const intg16* s = src + k;
+    const __m256i s1 = ENV_AVX2_LD(s + w), s2 = ENV_AVX2_LD(s + 2 * w), s3 = ENV_AVX2_LD(s + 3 * w);
+    const __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(s1, s2), c12),
+                                        _mm256_madd_epi16(_mm256_unpacklo_epi16(s3, zero), c10));
+    const __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(s1, s2), c12),
+                                        _mm256_madd_epi16(_mm256_unpackhi_epi16(s3, zero), c10));
+    ENV_AVX2_ST(dst + k, _mm256_packs_epi32(_mm256_srai_epi32(lo, 2), _mm256_srai_epi32(hi, 2)));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_sub_sat16(const intg16* a, const intg16* b, intg16* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 16 <= n; k += 16) ENV_AVX2_ST(dst + k, _mm256_subs_epi16(ENV_AVX2_LD(a + k), ENV_AVX2_LD(b + k)));
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_quad_energy16(const intg16* a, const intg16* b, intg16* dst, const env_size_t n)
+{
+  const __m256i maxv = _mm256_set1_epi16(INTG16_MAX);
+
+  env_size_t k = 0;
+  for (; k + 16 <= n; k += 16)
+  {
+    // abs() of -32768 is 0x8000, clamped to 32767 as an unsigned value:
+    const __m256i s1 = _mm256_min_epu16(_mm256_abs_epi16(ENV_AVX2_LD(a + k)), maxv);
+    const __m256i s2 = _mm256_min_epu16(_mm256_abs_epi16(ENV_AVX2_LD(b + k)), maxv);
+    const __m256i gt = _mm256_cmpgt_epi16(s1, s2);
+
+    const __m256i x = _mm256_blendv_epi8(_mm256_srai_epi16(s1, 1), s1, gt);
+    const __m256i y = _mm256_blendv_epi8(s2, _mm256_srai_epi16(s2, 1), gt);
+    ENV_AVX2_ST(dst + k, _mm256_adds_epi16(x, y));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_center_surround16(const intg16* c, const intg16* s, const int absol, intg16* dst,
+                                             const env_size_t n)
+{
+  env_size_t k = 0;
+  if (absol)
+    for (; k + 16 <= n; k += 16)
+    {
+      const __m256i vc = ENV_AVX2_LD(c + k), vs = ENV_AVX2_LD(s + k);
+      ENV_AVX2_ST(dst + k, _mm256_max_epi16(_mm256_subs_epi16(vc, vs), _mm256_subs_epi16(vs, vc)));
+    }
+  else
+  {
+    const __m256i zero = _mm256_setzero_si256();
+    for (; k + 16 <= n; k += 16)
+      ENV_AVX2_ST(dst + k, _mm256_max_epi16(_mm256_subs_epi16(ENV_AVX2_LD(c + k), ENV_AVX2_LD(s + k)), zero));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_clamp_minmax16(intg16* p, const env_size_t n, intg16* mi, intg16* ma)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i vmi = _mm256_set1_epi16(INTG16_MAX), vma = zero;
+
+  env_size_t k = 0;
+  for (; k + 16 <= n; k += 16)
+  {
+    const __m256i v = _mm256_max_epi16(ENV_AVX2_LD(p + k), zero);
+    ENV_AVX2_ST(p + k, v);
+    vmi = _mm256_min_epi16(vmi, v); vma = _mm256_max_epi16(vma, v);
+  }
+
+  if (k)
+  {
+    intg16 tmi[16], tma[16];
+    ENV_AVX2_ST(tmi, vmi); ENV_AVX2_ST(tma, vma);
+    *mi = tmi[0]; *ma = tma[0];
+    for (int i = 1; i < 16; ++i) { *mi = ENV_MIN(*mi, tmi[i]); *ma = ENV_MAX(*ma, tma[i]); }
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_normalize16(intg16* p, const env_size_t n, const intg16 mi, const intg16 nmin,
+                                       const intg32 factor)
+{
+  const __m256i vmi = _mm256_set1_epi16(mi), vnmin = _mm256_set1_epi16(nmin);
+  const __m256i fh = _mm256_set1_epi16((intg16) (factor >> 16));
+  const __m256i fl = _mm256_set1_epi16((intg16) (factor & 0xffff));
+
+  env_size_t k = 0;
+  for (; k + 16 <= n; k += 16)
+  {
+    const __m256i d = _mm256_sub_epi16(ENV_AVX2_LD(p + k), vmi);
+    ENV_AVX2_ST(p + k, _mm256_add_epi16(vnmin, _mm256_add_epi16(_mm256_mullo_epi16(d, fh),
+                                                                _mm256_mulhi_epu16(d, fl))));
+  }
+  return k;
+}
+
+// ######################################################################
+__attribute__((target("avx2")))
+static env_size_t env_avx2_local_max16(const intg16* p, const env_size_t w, const intg16 thresh, const env_size_t n,
+                                       env_size_t* numlm, intg32* lmsum)
+{
+  const __m256i th = _mm256_set1_epi16(thresh), ones = _mm256_set1_epi16(1);
+  __m256i sum = _mm256_setzero_si256(), cnt = _mm256_setzero_si256();
+
+  env_size_t k = 0;
+  for (; k + 16 <= n; k += 16)
+  {
+    const intg16* q = p + k;
+    const __m256i v = ENV_AVX2_LD(q);
+    const __m256i nb = _mm256_max_epi16(_mm256_max_epi16(ENV_AVX2_LD(q - 1), ENV_AVX2_LD(q + 1)),
+                                        _mm256_max_epi16(ENV_AVX2_LD(q - w), ENV_AVX2_LD(q + w)));
+    const __m256i lm = _mm256_cmpeq_epi16(_mm256_max_epi16(v, _mm256_max_epi16(nb, th)), v);
+
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_and_si256(v, lm), ones));
+    cnt = _mm256_sub_epi16(cnt, lm);
+  }
+
+  if (k)
+  {
+    intg32 tsum[8]; intg16 tcnt[16];
+    ENV_AVX2_ST(tsum, sum); ENV_AVX2_ST(tcnt, cnt);
+    for (int i = 0; i < 8; ++i) *lmsum += tsum[i];
+    for (int i = 0; i < 16; ++i) *numlm += (env_size_t) tcnt[i];
+  }
+  return k;
+}
+
+#endif // ENV_SIMD_X86
+
+#if defined(ENV_SIMD_ARM)
+
+// ######################################################################
+// ########## NEON
+// ######################################################################
+
+// ######################################################################
+static env_size_t env_neon_lowpass_9(const intg32* src, const env_size_t st, intg32* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 4 <= n; k += 4)
+  {
+    const intg32* s = src + k;
+    const int32x4_t a06 = vaddq_s32(vld1q_s32(s), vld1q_s32(s + 6 * st));
+    const int32x4_t a15 = vaddq_s32(vld1q_s32(s + st), vld1q_s32(s + 5 * st));
+    const int32x4_t a24 = vaddq_s32(vld1q_s32(s + 2 * st), vld1q_s32(s + 4 * st));
+    const int32x4_t a3 = vld1q_s32(s + 3 * st);
+
+    int32x4_t r = vshlq_n_s32(vaddq_s32(a06, vsubq_s32(a3, a24)), 3);
+    r = vaddq_s32(r, vsubq_s32(vshlq_n_s32(a15, 5), vshlq_n_s32(a15, 2)));
+    r = vaddq_s32(r, vshlq_n_s32(vaddq_s32(a24, a3), 6));
+
+    vst1q_s32(dst + k, vshrq_n_s32(r, 8));
+  }
+  return k;
+}
+
+// ######################################################################
+static env_size_t env_neon_lowpass_5_x_dec(const intg32* src, intg32* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 5 <= n; k += 4)
+  {
+    const intg32* s = src + 2 * k;
+    const int32x4x2_t a = vld2q_s32(s + 1); // s1 s3 s5 s7 / s2 s4 s6 s8
+    const int32x4x2_t c = vld2q_s32(s + 3); // s3 s5 s7 s9 / s4 s6 s8 s10
+
+    const int32x4_t r = vaddq_s32(vaddq_s32(a.val[0], c.val[0]), vshlq_n_s32(a.val[1], 1));
+    vst1q_s32(dst + k, vshrq_n_s32(r, 2));
+  }
+  return k;
+}
+
+// ######################################################################
+static env_size_t env_neon_lowpass_5_y_dec(const intg32* src, const env_size_t w, intg32* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 4 <= n; k += 4)
+  {
+    const intg32* s = src + k;
+    const int32x4_t r = vaddq_s32(vaddq_s32(vld1q_s32(s + w), vld1q_s32(s + 3 * w)),
+                                  vshlq_n_s32(vld1q_s32(s + 2 * w), 1));
+    vst1q_s32(dst + k, vshrq_n_s32(r, 2));
+  }
+  return k;
+}
+
+// ######################################################################
+static env_size_t env_neon_steerable_modulate(const intg32* src, const intg32* xa, const intg32* xb, const intg32 ya,
+                                              const intg32 yb, intg32* dst, const env_size_t n)
+{
+  const int32x4_t rnd = vdupq_n_s32(1 << (ENV_TRIG_NBITS - 1));
+
+  env_size_t k = 0;
+  for (; k + 4 <= n; k += 4)
+  {
+    const int32x4_t t = vmlaq_n_s32(vmlaq_n_s32(rnd, vld1q_s32(xa + k), ya), vld1q_s32(xb + k), yb);
+    const int32x4_t m = vmulq_s32(vld1q_s32(src + k), vshrq_n_s32(t, ENV_TRIG_NBITS));
+    vst1q_s32(dst + k, vshrq_n_s32(m, ENV_TRIG_NBITS + 1));
+  }
+  return k;
+}
+
+
+// ######################################################################
+// ########## NEON, 16-bit pixels
+// ######################################################################
+
+// ######################################################################
+// 9-tap lowpass of 4 pixels given the 7 taps, widened to 32 bits:
+static inline int16x4_t env_neon_lowpass_9_half16(const int16x4_t s0, const int16x4_t s1, const int16x4_t s2,
+                                                  const int16x4_t s3, const int16x4_t s4, const int16x4_t s5,
+                                                  const int16x4_t s6)
+{
+  int32x4_t r = vmull_n_s16(s3, 72);
+  r = vmlaq_n_s32(r, vaddl_s16(s0, s6), 8);
+  r = vmlaq_n_s32(r, vaddl_s16(s1, s5), 28);
+  r = vmlaq_n_s32(r, vaddl_s16(s2, s4), 56);
+  return vshrn_n_s32(r, 8);
+}
+
+// ######################################################################
+static env_size_t env_neon_lowpass_9_16(const intg16* src, const env_size_t st, intg16* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const intg16* s = src + k;
+    const int16x8_t s0 = vld1q_s16(s), s1 = vld1q_s16(s + st), s2 = vld1q_s16(s + 2 * st);
+    const int16x8_t s3 = vld1q_s16(s + 3 * st), s4 = vld1q_s16(s + 4 * st), s5 = vld1q_s16(s + 5 * st);
+    const int16x8_t s6 = vld1q_s16(s + 6 * st);
+
+    const int16x4_t lo = env_neon_lowpass_9_half16(vget_low_s16(s0), vget_low_s16(s1), vget_low_s16(s2),
+                                                   vget_low_s16(s3), vget_low_s16(s4), vget_low_s16(s5),
+                                                   vget_low_s16(s6));
+    const int16x4_t hi = env_neon_lowpass_9_half16(vget_high_s16(s0), vget_high_s16(s1), vget_high_s16(s2),
+                                                   vget_high_s16(s3), vget_high_s16(s4), vget_high_s16(s5),
+                                                   vget_high_s16(s6));
+    vst1q_s16(dst + k, vcombine_s16(lo, hi));
+  }
+  return k;
+}
+
+// ######################################################################
+// (a + 2*b + c) >> 2 of 8 pixels, widened to 32 bits:
+static inline int16x8_t env_neon_lowpass_5_vec16(const int16x8_t a, const int16x8_t b, const int16x8_t c)
+{
+  const int32x4_t lo = vaddq_s32(vaddl_s16(vget_low_s16(a), vget_low_s16(c)), vshll_n_s16(vget_low_s16(b), 1));
+  const int32x4_t hi = vaddq_s32(vaddl_s16(vget_high_s16(a), vget_high_s16(c)), vshll_n_s16(vget_high_s16(b), 1));
+  return vcombine_s16(vshrn_n_s32(lo, 2), vshrn_n_s32(hi, 2));
+}
+
+// ######################################################################
+static env_size_t env_neon_lowpass_5_x_dec16(const intg16* src, intg16* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 9 <= n; k += 8)
+  {
+    const intg16* s = src + 2 * k;
+    const int16x8x2_t a = vld2q_s16(s + 1); // s1 s3 .. s15 / s2 s4 .. s16
+    const int16x8x2_t c = vld2q_s16(s + 3); // s3 s5 .. s17 / s4 s6 .. s18
+    vst1q_s16(dst + k, env_neon_lowpass_5_vec16(a.val[0], a.val[1], c.val[0]));
+  }
+  return k;
+}
+
+// ######################################################################
+static env_size_t env_neon_lowpass_5_y_dec16(const intg16* src, const env_size_t w, intg16* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const intg16* s = src + k;
+    vst1q_s16(dst + k, env_neon_lowpass_5_vec16(vld1q_s16(s + w), vld1q_s16(s + 2 * w), vld1q_s16(s + 3 * w)));
+  }
+  return k;
+}
+
+// ######################################################################
+static env_size_t env_neon_sub_sat16(const intg16* a, const intg16* b, intg16* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8) vst1q_s16(dst + k, vqsubq_s16(vld1q_s16(a + k), vld1q_s16(b + k)));
+  return k;
+}
+
+// ######################################################################
+static env_size_t env_neon_quad_energy16(const intg16* a, const intg16* b, intg16* dst, const env_size_t n)
+{
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const int16x8_t s1 = vqabsq_s16(vld1q_s16(a + k)), s2 = vqabsq_s16(vld1q_s16(b + k));
+    const uint16x8_t gt = vcgtq_s16(s1, s2);
+    const int16x8_t x = vbslq_s16(gt, s1, vshrq_n_s16(s1, 1));
+    const int16x8_t y = vbslq_s16(gt, vshrq_n_s16(s2, 1), s2);
+    vst1q_s16(dst + k, vqaddq_s16(x, y));
+  }
+  return k;
+}
+
+// ######################################################################
+static env_size_t env_neon_center_surround16(const intg16* c, const intg16* s, const int absol, intg16* dst,
+                                             const env_size_t n)
+{
+  env_size_t k = 0;
+  if (absol)
+    for (; k + 8 <= n; k += 8)
+    {
+      const int16x8_t vc = vld1q_s16(c + k), vs = vld1q_s16(s + k);
+      vst1q_s16(dst + k, vmaxq_s16(vqsubq_s16(vc, vs), vqsubq_s16(vs, vc)));
+    }
+  else
+  {
+    const int16x8_t zero = vdupq_n_s16(0);
+    for (; k + 8 <= n; k += 8) vst1q_s16(dst + k, vmaxq_s16(vqsubq_s16(vld1q_s16(c + k), vld1q_s16(s + k)), zero));
+  }
+  return k;
+}
+
+// ######################################################################
+static env_size_t env_neon_clamp_minmax16(intg16* p, const env_size_t n, intg16* mi, intg16* ma)
+{
+  const int16x8_t zero = vdupq_n_s16(0);
+  int16x8_t vmi = vdupq_n_s16(INTG16_MAX), vma = zero;
+
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const int16x8_t v = vmaxq_s16(vld1q_s16(p + k), zero);
+    vst1q_s16(p + k, v);
+    vmi = vminq_s16(vmi, v); vma = vmaxq_s16(vma, v);
+  }
+
+  if (k)
+  {
+    intg16 tmi[8], tma[8];
+    vst1q_s16(tmi, vmi); vst1q_s16(tma, vma);
+    *mi = tmi[0]; *ma = tma[0];
+    for (int i = 1; i < 8; ++i) { *mi = ENV_MIN(*mi, tmi[i]); *ma = ENV_MAX(*ma, tma[i]); }
+  }
+  return k;
+}
+
+// ######################################################################
+static env_size_t env_neon_normalize16(intg16* p, const env_size_t n, const intg16 mi, const intg16 nmin,
+                                       const intg32 factor)
+{
+  const int16x8_t vmi = vdupq_n_s16(mi), vnmin = vdupq_n_s16(nmin);
+  const uint16_t fh = (uint16_t) (factor >> 16), fl = (uint16_t) (factor & 0xffff);
+
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const uint16x8_t d = vreinterpretq_u16_s16(vsubq_s16(vld1q_s16(p + k), vmi));
+    const uint16x8_t lo = vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(d), fl), 16),
+                                       vshrn_n_u32(vmull_n_u16(vget_high_u16(d), fl), 16));
+    const uint16x8_t r = vaddq_u16(vmulq_n_u16(d, fh), lo);
+    vst1q_s16(p + k, vaddq_s16(vnmin, vreinterpretq_s16_u16(r)));
+  }
+  return k;
+}
+
+// ######################################################################
+static env_size_t env_neon_local_max16(const intg16* p, const env_size_t w, const intg16 thresh, const env_size_t n,
+                                       env_size_t* numlm, intg32* lmsum)
+{
+  const int16x8_t th = vdupq_n_s16(thresh);
+  int32x4_t sum = vdupq_n_s32(0); uint16x8_t cnt = vdupq_n_u16(0);
+
+  env_size_t k = 0;
+  for (; k + 8 <= n; k += 8)
+  {
+    const intg16* q = p + k;
+    const int16x8_t v = vld1q_s16(q);
+    const int16x8_t nb = vmaxq_s16(vmaxq_s16(vld1q_s16(q - 1), vld1q_s16(q + 1)),
+                                   vmaxq_s16(vld1q_s16(q - w), vld1q_s16(q + w)));
+    const uint16x8_t lm = vcgeq_s16(v, vmaxq_s16(nb, th));
+
+    sum = vpadalq_s16(sum, vandq_s16(v, vreinterpretq_s16_u16(lm)));
+    cnt = vsubq_u16(cnt, lm);
+  }
+
+  if (k)
+  {
+    intg32 tsum[4]; uint16_t tcnt[8];
+    vst1q_s32(tsum, sum); vst1q_u16(tcnt, cnt);
+    for (int i = 0; i < 4; ++i) *lmsum += tsum[i];
+    for (int i = 0; i < 8; ++i) *numlm += tcnt[i];
+  }
+  return k;
+}
+
+#endif // ENV_SIMD_ARM
+
+// ######################################################################
+// ########## Dispatch
+// ######################################################################
+
+// ######################################################################
+env_size_t env_simd_lowpass_5_x_dec(const intg32* src, intg32* dst, const env_size_t n)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_lowpass_5_x_dec(src, dst, n);
+  case ENV_SIMD_SSE2: return env_sse2_lowpass_5_x_dec(src, dst, n);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_lowpass_5_x_dec(src, dst, n);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_lowpass_5_y_dec(const intg32* src, const env_size_t w, intg32* dst, const env_size_t n)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_lowpass_5_y_dec(src, w, dst, n);
+  case ENV_SIMD_SSE2: return env_sse2_lowpass_5_y_dec(src, w, dst, n);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_lowpass_5_y_dec(src, w, dst, n);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_lowpass_9(const intg32* src, const env_size_t stride, intg32* dst, const env_size_t n)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_lowpass_9(src, stride, dst, n);
+  case ENV_SIMD_SSE2: return env_sse2_lowpass_9(src, stride, dst, n);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_lowpass_9(src, stride, dst, n);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_steerable_modulate(const intg32* src, const intg32* xa, const intg32* xb, const intg32 ya,
+                                       const intg32 yb, intg32* dst, const env_size_t n)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_steerable_modulate(src, xa, xb, ya, yb, dst, n);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_steerable_modulate(src, xa, xb, ya, yb, dst, n);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_lowpass_5_x_dec16(const intg16* src, intg16* dst, const env_size_t n)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_lowpass_5_x_dec16(src, dst, n);
+  case ENV_SIMD_SSE2: return env_sse2_lowpass_5_x_dec16(src, dst, n);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_lowpass_5_x_dec16(src, dst, n);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_lowpass_5_y_dec16(const intg16* src, const env_size_t w, intg16* dst, const env_size_t n)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_lowpass_5_y_dec16(src, w, dst, n);
+  case ENV_SIMD_SSE2: return env_sse2_lowpass_5_y_dec16(src, w, dst, n);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_lowpass_5_y_dec16(src, w, dst, n);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_lowpass_9_16(const intg16* src, const env_size_t stride, intg16* dst, const env_size_t n)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_lowpass_9_16(src, stride, dst, n);
+  case ENV_SIMD_SSE2: return env_sse2_lowpass_9_16(src, stride, dst, n);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_lowpass_9_16(src, stride, dst, n);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_sub_sat16(const intg16* a, const intg16* b, intg16* dst, const env_size_t n)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_sub_sat16(a, b, dst, n);
+  case ENV_SIMD_SSE2: return env_sse2_sub_sat16(a, b, dst, n);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_sub_sat16(a, b, dst, n);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_quad_energy16(const intg16* a, const intg16* b, intg16* dst, const env_size_t n)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_quad_energy16(a, b, dst, n);
+  case ENV_SIMD_SSE2: return env_sse2_quad_energy16(a, b, dst, n);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_quad_energy16(a, b, dst, n);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_center_surround16(const intg16* c, const intg16* s, const int absol, intg16* dst,
+                                      const env_size_t n)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_center_surround16(c, s, absol, dst, n);
+  case ENV_SIMD_SSE2: return env_sse2_center_surround16(c, s, absol, dst, n);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_center_surround16(c, s, absol, dst, n);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_clamp_minmax16(intg16* p, const env_size_t n, intg16* mi, intg16* ma)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_clamp_minmax16(p, n, mi, ma);
+  case ENV_SIMD_SSE2: return env_sse2_clamp_minmax16(p, n, mi, ma);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_clamp_minmax16(p, n, mi, ma);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_normalize16(intg16* p, const env_size_t n, const intg16 mi, const intg16 nmin,
+                                const intg32 factor)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_normalize16(p, n, mi, nmin, factor);
+  case ENV_SIMD_SSE2: return env_sse2_normalize16(p, n, mi, nmin, factor);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_normalize16(p, n, mi, nmin, factor);
+#endif
+  default: return 0;
+  }
+}
+
+// ######################################################################
+env_size_t env_simd_local_max16(const intg16* p, const env_size_t w, const intg16 thresh, const env_size_t n,
+                                env_size_t* numlm, intg32* lmsum)
+{
+  switch (g_simd_level)
+  {
+#if defined(ENV_SIMD_X86)
+  case ENV_SIMD_AVX2: return env_avx2_local_max16(p, w, thresh, n, numlm, lmsum);
+  case ENV_SIMD_SSE2: return env_sse2_local_max16(p, w, thresh, n, numlm, lmsum);
+#elif defined(ENV_SIMD_ARM)
+  case ENV_SIMD_NEON: return env_neon_local_max16(p, w, thresh, n, numlm, lmsum);
+#endif
+  default: return 0;
+  }
+}
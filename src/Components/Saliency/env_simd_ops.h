@@ -0,0 +1,125 @@
+/*!@file Envision/env_simd_ops.h Vectorized inner loops of the fixed-point lowpass, steerable and 16-bit filters */
+
+// //////////////////////////////////////////////////////////////////// //
+// The iLab Neuromorphic Vision C++ Toolkit - Copyright (C) 2001 by the //
+// University of Southern California (USC) and the iLab at USC.         //
+// See http://iLab.usc.edu for information about this project.          //
+// //////////////////////////////////////////////////////////////////// //
+// Major portions of the iLab Neuromorphic Vision Toolkit are protected //
+// under the U.S. patent ``Computation of Intrinsic Perceptual Saliency //
+// in Visual Environments, and Applications'' by Christof Koch and      //
+// Laurent Itti, California Institute of Technology, 2001 (patent       //
+// pending; application number 09/912,225 filed July 23, 2001; see      //
+// http://pair.uspto.gov/cgi-bin/final/home.pl for current status).     //
+// //////////////////////////////////////////////////////////////////// //
+// This file is part of the iLab Neuromorphic Vision C++ Toolkit.       //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is free software; you can   //
+// redistribute it and/or modify it under the terms of the GNU General  //
+// Public License as published by the Free Software Foundation; either  //
+// version 2 of the License, or (at your option) any later version.     //
+//                                                                      //
+// The iLab Neuromorphic Vision C++ Toolkit is distributed in the hope  //
+// that it will be useful, but WITHOUT ANY WARRANTY; without even the   //
+// implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR      //
+// PURPOSE.  See the GNU General Public License for more details.       //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with the iLab Neuromorphic Vision C++ Toolkit; if not, write   //
+// to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,   //
+// Boston, MA 02111-1307 USA.                                           //
+// //////////////////////////////////////////////////////////////////// //
+//
+
+#pragma once
+
+#include <jevoisbase/src/Components/Saliency/env_types.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  //! Instruction sets that can be used by the vectorized kernels
+  enum env_simd_level
+    {
+      ENV_SIMD_NONE = 0, //!< Plain C, scalar code only
+      ENV_SIMD_SSE2 = 1, //!< Intel/AMD SSE2, 4 pixels at a time
+      ENV_SIMD_AVX2 = 2, //!< Intel/AMD AVX2, 8 pixels at a time
+      ENV_SIMD_NEON = 3  //!< ARM NEON, 4 pixels at a time
+    };
+
+  //! Get the instruction set currently used by the kernels
+  /*! By default this is the best one supported by the host CPU, as detected at program startup. */
+  enum env_simd_level env_simd_get_level(void);
+
+  //! Select the instruction set to use, mainly useful to compare against the scalar code
+  /*! Requests for a level not supported by the CPU fall back to the scalar code. Not thread-safe with respect to
+      concurrent filtering. Returns the level actually selected. */
+  enum env_simd_level env_simd_set_level(const enum env_simd_level level);
+
+  //! Interior of the decimating 5-tap horizontal lowpass: dst[k] = (src[2k+1] + 2*src[2k+2] + src[2k+3]) >> 2
+  /*! Reads from src[1] to src[2*n+1]. Returns the number m <= n of leading outputs that were computed, the caller
+      must compute the remaining ones in scalar code. */
+  env_size_t env_simd_lowpass_5_x_dec(const intg32* src, intg32* dst, const env_size_t n);
+
+  //! Interior of the decimating 5-tap vertical lowpass: dst[k] = (src[k+w] + 2*src[k+2w] + src[k+3w]) >> 2
+  /*! Returns the number m <= n of leading outputs that were computed, the caller must compute the remaining ones in
+      scalar code. */
+  env_size_t env_simd_lowpass_5_y_dec(const intg32* src, const env_size_t w, intg32* dst, const env_size_t n);
+
+  //! Interior of the 9-tap lowpass along a direction with given stride (1 for horizontal, image width for vertical)
+  /*! dst[k] = ((s0 + s6) * 8 + (s1 + s5) * 28 + (s2 + s4) * 56 + s3 * 72) >> 8 with si = src[k + i*stride]. Returns
+      the number m <= n of leading outputs that were computed, the caller must compute the remaining ones in scalar
+      code. */
+  env_size_t env_simd_lowpass_9(const intg32* src, const env_size_t stride, intg32* dst, const env_size_t n);
+
+  //! Modulation of a row by a steerable filter phasor, for env_steerable_filter_bank()
+  /*! dst[k] = (src[k] * t) >> (ENV_TRIG_NBITS+1) with t = (xa[k] * ya + xb[k] * yb + (1 << (ENV_TRIG_NBITS-1))) >>
+      ENV_TRIG_NBITS. Returns the number m <= n of leading outputs that were computed, the caller must compute the
+      remaining ones in scalar code. SSE2 lacks 32-bit multiplications, so nothing is computed with it. */
+  env_size_t env_simd_steerable_modulate(const intg32* src, const intg32* xa, const intg32* xb, const intg32 ya,
+                                         const intg32 yb, intg32* dst, const env_size_t n);
+
+  // The kernels below work on the 16-bit pixels of env_image16, 8 pixels at a time with SSE2 and NEON, 16 with AVX2.
+
+  //! 16-bit version of env_simd_lowpass_5_x_dec()
+  /*! Reads from src[1] to src[2*n+1]. */
+  env_size_t env_simd_lowpass_5_x_dec16(const intg16* src, intg16* dst, const env_size_t n);
+
+  //! 16-bit version of env_simd_lowpass_5_y_dec()
+  env_size_t env_simd_lowpass_5_y_dec16(const intg16* src, const env_size_t w, intg16* dst, const env_size_t n);
+
+  //! 16-bit version of env_simd_lowpass_9()
+  env_size_t env_simd_lowpass_9_16(const intg16* src, const env_size_t stride, intg16* dst, const env_size_t n);
+
+  //! Saturated difference: dst[k] = env_sat16(a[k] - b[k])
+  env_size_t env_simd_sub_sat16(const intg16* a, const intg16* b, intg16* dst, const env_size_t n);
+
+  //! Paeth approximation of the quadrature energy, same as env_quad_energy16()
+  env_size_t env_simd_quad_energy16(const intg16* a, const intg16* b, intg16* dst, const env_size_t n);
+
+  //! Center-surround difference against a surround row already expanded to the center width
+  /*! dst[k] = env_sat16(c[k] - s[k]) if c[k] > s[k], else env_sat16(s[k] - c[k]) if absol is non-zero, else 0. */
+  env_size_t env_simd_center_surround16(const intg16* c, const intg16* s, const int absol, intg16* dst,
+                                        const env_size_t n);
+
+  //! Clamp negative values to zero in place, and get the min and max of the clamped values
+  /*! The min and max are only written when the returned number of leading values processed is non-zero. */
+  env_size_t env_simd_clamp_minmax16(intg16* p, const env_size_t n, intg16* mi, intg16* ma);
+
+  //! Linear rescaling in place: p[k] = nmin + (((p[k] - mi) * factor) >> 16)
+  /*! Requires 0 <= p[k] - mi and (p[k] - mi) * factor < 2^31, as is the case in env_max_normalize16_inplace(). */
+  env_size_t env_simd_normalize16(intg16* p, const env_size_t n, const intg16 mi, const intg16 nmin,
+                                  const intg32 factor);
+
+  //! Count and sum the local maxima above a threshold, for env_max_normalize16_inplace()
+  /*! p[k] is a local max if p[k] >= thresh and p[k] is not smaller than p[k-1], p[k+1], p[k-w] and p[k+w]. Adds the
+      number of local maxima among the leading values processed to *numlm, and their sum to *lmsum. Values must be
+      non-negative, and n less than 2^16. */
+  env_size_t env_simd_local_max16(const intg16* p, const env_size_t w, const intg16 thresh, const env_size_t n,
+                                  env_size_t* numlm, intg32* lmsum);
+
+#ifdef __cplusplus
+}
+#endif